@@ -0,0 +1,203 @@
+// binary-fuse-filter.c
+// -----------------------------------------------------------------------------
+// Static 8-bit binary fuse filter with three probes (see binary-fuse-filter.h).
+// Construction follows the reference implementation by Graf and Lemire.
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "binary-fuse-filter.h"
+#include "bloom-hash.h"
+
+#define ARITY 3
+#define MAX_SEGMENT_LENGTH 262144
+#define MAX_ATTEMPTS 100 // Each failed peel retries with a new seed
+
+static inline uint8_t fingerprint_of(uint64_t hash)
+{
+    return (uint8_t)(hash ^ (hash >> 32));
+}
+
+// Slot of probe index (0..2): segment chosen by the high bits, then a
+// per-probe offset inside the following segments
+static inline uint32_t slot_of(const binary_fuse_t *bff, uint64_t hash, int index)
+{
+    uint64_t h = bloom_reduce(hash, bff->segment_count_length);
+    h += (uint64_t)index * bff->segment_length;
+    uint64_t hh = hash & ((1ULL << 36) - 1);
+    h ^= (hh >> (36 - 18 * index)) & bff->segment_length_mask;
+    return (uint32_t)h;
+}
+
+// Array geometry for a given key count (sizes from the reference code)
+static void compute_geometry(binary_fuse_t *bff, uint32_t size)
+{
+    uint32_t segment_length = 4;
+    double size_factor = 0;
+    if (size > 1)
+    {
+        segment_length = 1u << (int)floor(log((double)size) / log(3.33) + 2.25);
+        size_factor = fmax(1.125, 0.875 + 0.25 * log(1000000.0) / log((double)size));
+    }
+    if (segment_length > MAX_SEGMENT_LENGTH)
+        segment_length = MAX_SEGMENT_LENGTH;
+
+    uint32_t capacity = (uint32_t)round((double)size * size_factor);
+    uint32_t segment_count = (capacity + segment_length - 1) / segment_length;
+    segment_count = segment_count > ARITY - 1 ? segment_count - (ARITY - 1) : 1;
+
+    bff->segment_length = segment_length;
+    bff->segment_length_mask = segment_length - 1;
+    bff->segment_count = segment_count;
+    bff->segment_count_length = segment_count * segment_length;
+    bff->array_length = (segment_count + ARITY - 1) * segment_length;
+}
+
+/*------------------------------------------------
+  One construction attempt with bff->seed
+  - Records every key's three slots in per-slot
+    counters (count << 2 | xor of probe indices)
+    and per-slot xors of the key hashes
+  - Peels slots that hold exactly one key
+  - Assigns fingerprints in reverse peel order
+  Returns 0 on success, -1 if peeling got stuck
+-------------------------------------------------*/
+static int try_build(binary_fuse_t *bff, const bloom_key_t *keys, uint32_t size,
+                     uint8_t *t2count, uint64_t *t2hash, uint32_t *alone,
+                     uint64_t *reverse_hash, uint8_t *reverse_order)
+{
+    memset(t2count, 0, bff->array_length);
+    memset(t2hash, 0, (size_t)bff->array_length * sizeof(uint64_t));
+
+    for (uint32_t iterator = 0; iterator < size; iterator++)
+    {
+        uint64_t hash = bloom_hash64(keys[iterator].data, keys[iterator].len, bff->seed);
+        for (int index = 0; index < ARITY; index++)
+        {
+            uint32_t slot = slot_of(bff, hash, index);
+            t2count[slot] += 4;
+            t2count[slot] ^= (uint8_t)index;
+            t2hash[slot] ^= hash;
+            if (t2count[slot] < 4)
+                return -1; // 8-bit counter overflowed: hopeless seed
+        }
+    }
+
+    uint32_t queue_size = 0;
+    for (uint32_t slot = 0; slot < bff->array_length; slot++)
+    {
+        if ((t2count[slot] >> 2) == 1)
+            alone[queue_size++] = slot;
+    }
+
+    uint32_t stack_size = 0;
+    while (queue_size > 0)
+    {
+        uint32_t slot = alone[--queue_size];
+        if ((t2count[slot] >> 2) != 1)
+            continue; // Its only key was peeled through another slot
+
+        uint64_t hash = t2hash[slot];
+        uint8_t found = t2count[slot] & 3;
+        reverse_hash[stack_size] = hash;
+        reverse_order[stack_size] = found;
+        stack_size++;
+
+        // Remove the key from its other two slots
+        for (int step = 1; step < ARITY; step++)
+        {
+            int index = (found + step) % ARITY;
+            uint32_t other = slot_of(bff, hash, index);
+            if ((t2count[other] >> 2) == 2)
+                alone[queue_size++] = other;
+            t2count[other] -= 4;
+            t2count[other] ^= (uint8_t)index;
+            t2hash[other] ^= hash;
+        }
+    }
+    if (stack_size != size)
+        return -1;
+
+    memset(bff->fingerprints, 0, bff->array_length);
+    for (uint32_t iterator = size; iterator-- > 0;)
+    {
+        uint64_t hash = reverse_hash[iterator];
+        int found = reverse_order[iterator];
+        uint32_t slots[ARITY];
+        for (int index = 0; index < ARITY; index++)
+        {
+            slots[index] = slot_of(bff, hash, index);
+        }
+        bff->fingerprints[slots[found]] = fingerprint_of(hash) ^
+                                          bff->fingerprints[slots[(found + 1) % ARITY]] ^
+                                          bff->fingerprints[slots[(found + 2) % ARITY]];
+    }
+    return 0;
+}
+
+binary_fuse_t *binary_fuse_build(const bloom_key_t *keys, size_t count)
+{
+    if (count > UINT32_MAX)
+        return NULL;
+    uint32_t size = (uint32_t)count;
+
+    binary_fuse_t *bff = calloc(1, sizeof(*bff));
+    if (bff == NULL)
+        return NULL;
+    compute_geometry(bff, size);
+    bff->num_keys = size;
+
+    bff->fingerprints = malloc(bff->array_length);
+    uint8_t *t2count = malloc(bff->array_length);
+    uint64_t *t2hash = malloc((size_t)bff->array_length * sizeof(uint64_t));
+    uint32_t *alone = malloc((size_t)bff->array_length * sizeof(uint32_t));
+    uint64_t *reverse_hash = malloc(((size_t)size + 1) * sizeof(uint64_t));
+    uint8_t *reverse_order = malloc((size_t)size + 1);
+
+    int built = 0;
+    if (bff->fingerprints != NULL && t2count != NULL && t2hash != NULL && alone != NULL &&
+        reverse_hash != NULL && reverse_order != NULL)
+    {
+        for (int attempt = 0; attempt < MAX_ATTEMPTS && !built; attempt++)
+        {
+            bff->seed = BLOOM_DEFAULT_SEED + (uint64_t)attempt * 0x9e3779b97f4a7c15ULL;
+            built = try_build(bff, keys, size, t2count, t2hash, alone, reverse_hash, reverse_order) == 0;
+        }
+    }
+
+    free(t2count);
+    free(t2hash);
+    free(alone);
+    free(reverse_hash);
+    free(reverse_order);
+    if (!built)
+    {
+        binary_fuse_destroy(bff);
+        return NULL;
+    }
+    return bff;
+}
+
+void binary_fuse_destroy(binary_fuse_t *bff)
+{
+    if (bff == NULL)
+        return;
+    free(bff->fingerprints);
+    free(bff);
+}
+
+int binary_fuse_search(const binary_fuse_t *bff, const void *key, size_t len)
+{
+    uint64_t hash = bloom_hash64(key, len, bff->seed);
+    uint8_t f = fingerprint_of(hash);
+    f ^= bff->fingerprints[slot_of(bff, hash, 0)] ^
+         bff->fingerprints[slot_of(bff, hash, 1)] ^
+         bff->fingerprints[slot_of(bff, hash, 2)];
+    return f == 0;
+}
+
+size_t binary_fuse_memory(const binary_fuse_t *bff)
+{
+    return sizeof(*bff) + bff->array_length;
+}
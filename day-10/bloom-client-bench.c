@@ -0,0 +1,216 @@
+/*
+ * Bloom filter membership service throughput benchmark
+ *
+ * Forks num_clients processes; each opens its own connection to
+ * bloom-server and sends queries of batch_size keys back to back for a fixed
+ * time. This runs once per batch size, so the output shows how batching
+ * amortizes the syscall, wake-up and framing cost of each round trip.
+ *
+ * Connecting and building the key pools happen before the clock starts: the
+ * clients report ready over a pipe and are released together.
+ *
+ * Keys are "key-<r>" with r uniform in [0, 2 * key_space): against a filter
+ * built from key-0 .. key-<key_space - 1> about half of them are present.
+ *
+ * Build: gcc -O2 bloom-client-bench.c bloom-client.c -o bloom-client-bench
+ * Usage: ./bloom-client-bench <num_clients> <seconds_per_step> [key_space] [socket_path]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "bloom-client.h"
+
+#define KEY_SLOT 24  // Bytes reserved per pre-generated key
+#define POOL_KEYS 65536 // Keys generated per client, cycled through
+
+/* Written by each child into a shared mapping, read by the parent */
+typedef struct
+{
+    uint64_t requests;
+    uint64_t keys;
+    uint64_t hits;
+    int failed;
+} __attribute__((aligned(64))) client_result_t;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: cheap per-process key selection
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/*
+ * One client process. Reports on ready_fd once connected and its key pool is
+ * built, then blocks on go_fd until the parent closes it: the timed window
+ * starts only when every client can send.
+ */
+static void run_client(const char *path, size_t batch_size, double seconds, uint64_t key_space,
+                       uint64_t seed, client_result_t *result, int ready_fd, int go_fd)
+{
+    bloom_client_t *client = bloom_client_connect(path);
+    bloom_key_t *pool = malloc(POOL_KEYS * sizeof(bloom_key_t));
+    char *storage = malloc(POOL_KEYS * KEY_SLOT);
+    uint64_t *bitmap = malloc((batch_size + 63) / 64 * sizeof(uint64_t));
+    if (client == NULL || pool == NULL || storage == NULL || bitmap == NULL)
+    {
+        perror("client setup");
+        result->failed = 1;
+        if (write(ready_fd, "x", 1) != 1) // Still report, or the parent waits forever
+            perror("write");
+        return;
+    }
+
+    uint64_t state = seed | 1;
+    for (size_t iterator = 0; iterator < POOL_KEYS; iterator++)
+    {
+        char *slot = storage + iterator * KEY_SLOT;
+        pool[iterator].data = slot;
+        pool[iterator].len = (size_t)snprintf(slot, KEY_SLOT, "key-%lu",
+                                              (unsigned long)(next_random(&state) % (2 * key_space)));
+    }
+
+    char go;
+    if (write(ready_fd, "x", 1) != 1 || read(go_fd, &go, 1) < 0) // read: EOF once the clock starts
+    {
+        perror("client handshake");
+        result->failed = 1;
+        return;
+    }
+
+    size_t offset = 0;
+    double deadline = now_seconds() + seconds;
+    while (now_seconds() < deadline)
+    {
+        if (offset + batch_size > POOL_KEYS)
+            offset = 0;
+        if (bloom_client_query(client, pool + offset, batch_size, bitmap) < 0)
+        {
+            perror("bloom_client_query");
+            result->failed = 1;
+            break;
+        }
+        for (size_t iterator = 0; iterator < (batch_size + 63) / 64; iterator++)
+        {
+            result->hits += (uint64_t)__builtin_popcountll(bitmap[iterator]);
+        }
+        result->requests++;
+        result->keys += batch_size;
+        offset += batch_size;
+    }
+
+    bloom_client_close(client);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3 || argc > 5)
+    {
+        fprintf(stderr, "Usage: %s <num_clients> <seconds_per_step> [key_space] [socket_path]\n", argv[0]);
+        return 1;
+    }
+
+    int num_clients = atoi(argv[1]);
+    double seconds = atof(argv[2]);
+    uint64_t key_space = argc >= 4 ? strtoull(argv[3], NULL, 10) : 1000000;
+    const char *path = argc == 5 ? argv[4] : BLOOM_SOCKET_PATH;
+    if (num_clients <= 0 || seconds <= 0.0 || key_space == 0)
+    {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+
+    client_result_t *results = mmap(NULL, (size_t)num_clients * sizeof(client_result_t), PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+
+    const size_t batch_sizes[] = {1, 16, 256, 4096, 65536};
+    const int num_steps = (int)(sizeof(batch_sizes) / sizeof(batch_sizes[0]));
+
+    printf("%d client processes, %.1f s per step, server %s\n", num_clients, seconds, path);
+    printf("%10s %14s %14s %14s %10s\n", "batch", "requests/s", "keys/s", "us/request", "hit rate");
+
+    for (int step = 0; step < num_steps; step++)
+    {
+        memset(results, 0, (size_t)num_clients * sizeof(client_result_t));
+
+        /* Fork and set up every client, then start them together */
+        int ready[2], go[2];
+        if (pipe(ready) < 0 || pipe(go) < 0)
+        {
+            perror("pipe");
+            return 1;
+        }
+        for (int iterator = 0; iterator < num_clients; iterator++)
+        {
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                perror("fork");
+                return 1;
+            }
+            if (pid == 0)
+            {
+                close(ready[0]);
+                close(go[1]);
+                run_client(path, batch_sizes[step], seconds, key_space,
+                           0x9e3779b97f4a7c15ULL * (uint64_t)(iterator + 1) + (uint64_t)step, &results[iterator],
+                           ready[1], go[0]);
+                _exit(0);
+            }
+        }
+        close(ready[1]);
+        close(go[0]);
+        char byte;
+        for (int iterator = 0; iterator < num_clients; iterator++)
+        {
+            if (read(ready[0], &byte, 1) != 1)
+                break;
+        }
+        close(ready[0]);
+
+        double start = now_seconds();
+        close(go[1]);
+        while (wait(NULL) > 0)
+            ;
+        double elapsed = now_seconds() - start;
+
+        uint64_t requests = 0, keys = 0, hits = 0;
+        for (int iterator = 0; iterator < num_clients; iterator++)
+        {
+            if (results[iterator].failed)
+            {
+                fprintf(stderr, "client %d failed (is bloom-server running?)\n", iterator);
+                return 1;
+            }
+            requests += results[iterator].requests;
+            keys += results[iterator].keys;
+            hits += results[iterator].hits;
+        }
+
+        printf("%10zu %14.0f %14.0f %14.2f %9.1f%%\n", batch_sizes[step], (double)requests / elapsed,
+               (double)keys / elapsed, elapsed * 1e6 * num_clients / (double)(requests ? requests : 1),
+               keys ? 100.0 * (double)hits / (double)keys : 0.0);
+    }
+
+    munmap(results, (size_t)num_clients * sizeof(client_result_t));
+    return 0;
+}
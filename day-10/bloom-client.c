@@ -0,0 +1,229 @@
+// bloom-client.c
+// -----------------------------------------------------------------------------
+// Bloom filter membership service client (see bloom-client.h).
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "bloom-client.h"
+
+/*------------------------------------------------
+  Send all bytes to socket
+  - Handles partial writes
+  - MSG_NOSIGNAL: a dead server gives EPIPE, not SIGPIPE
+  - Returns 0 on success, -1 on error
+-------------------------------------------------*/
+static int send_all(int fd, const void *buf, size_t len)
+{
+    const char *p = (const char *)buf;
+    while (len > 0)
+    {
+        ssize_t w = send(fd, p, len, MSG_NOSIGNAL);
+        if (w < 0)
+        {
+            if (errno == EINTR)
+                continue; // Interrupted -> retry
+            return -1;    // Error
+        }
+        p += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+/*------------------------------------------------
+  Read exactly len bytes from socket
+  - Returns 0 on success, -1 on error or early EOF
+-------------------------------------------------*/
+static int read_full(int fd, void *buf, size_t len)
+{
+    char *p = (char *)buf;
+    while (len > 0)
+    {
+        ssize_t r = read(fd, p, len);
+        if (r == 0)
+        {
+            errno = EPROTO; // Server closed mid-reply
+            return -1;
+        }
+        if (r < 0)
+        {
+            if (errno == EINTR)
+                continue; // Interrupted -> retry
+            return -1;    // Error
+        }
+        p += r;
+        len -= (size_t)r;
+    }
+    return 0;
+}
+
+bloom_client_t *bloom_client_connect(const char *path)
+{
+    if (path == NULL)
+        path = BLOOM_SOCKET_PATH;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return NULL;
+    }
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+        return NULL;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1)
+    {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return NULL;
+    }
+
+    bloom_client_t *client = calloc(1, sizeof(*client));
+    if (client == NULL)
+    {
+        close(fd);
+        return NULL;
+    }
+    client->fd = fd;
+    return client;
+}
+
+void bloom_client_close(bloom_client_t *client)
+{
+    if (client == NULL)
+        return;
+    close(client->fd);
+    free(client->buffer);
+    free(client);
+}
+
+static int reserve(bloom_client_t *client, size_t size)
+{
+    if (size <= client->capacity)
+        return 0;
+    size_t capacity = client->capacity ? client->capacity : 64 * 1024;
+    while (capacity < size)
+        capacity *= 2;
+    unsigned char *buffer = realloc(client->buffer, capacity);
+    if (buffer == NULL)
+        return -1;
+    client->buffer = buffer;
+    client->capacity = capacity;
+    return 0;
+}
+
+// One round trip for keys[0 .. count): count and payload are within limits
+static int query_chunk(bloom_client_t *client, const bloom_key_t *keys, uint32_t count,
+                       size_t key_bytes, uint64_t *results)
+{
+    size_t payload_len = (size_t)count * sizeof(uint32_t) + key_bytes;
+    if (reserve(client, sizeof(bloom_request_t) + payload_len) < 0)
+        return -1;
+
+    /* Assemble header, lengths and key bytes in one buffer: one send() per request */
+    bloom_request_t *request = (bloom_request_t *)client->buffer;
+    request->magic = BLOOM_PROTO_MAGIC;
+    request->op = BLOOM_OP_QUERY;
+    request->count = count;
+    request->payload_len = (uint32_t)payload_len;
+
+    uint32_t *lengths = (uint32_t *)(request + 1);
+    unsigned char *bytes = (unsigned char *)(lengths + count);
+    for (uint32_t iterator = 0; iterator < count; iterator++)
+    {
+        lengths[iterator] = (uint32_t)keys[iterator].len;
+        memcpy(bytes, keys[iterator].data, keys[iterator].len);
+        bytes += keys[iterator].len;
+    }
+    if (send_all(client->fd, client->buffer, sizeof(bloom_request_t) + payload_len) < 0)
+        return -1;
+
+    /* Reply: header, then the bitmap straight into the caller's array */
+    bloom_response_t response;
+    if (read_full(client->fd, &response, sizeof(response)) < 0)
+        return -1;
+    if (response.magic != BLOOM_PROTO_MAGIC || response.status != BLOOM_STATUS_OK || response.count != count)
+    {
+        errno = EPROTO;
+        return -1;
+    }
+    return read_full(client->fd, results, ((size_t)count + 63) / 64 * sizeof(uint64_t));
+}
+
+int bloom_client_query(bloom_client_t *client, const bloom_key_t *keys, size_t count, uint64_t *results)
+{
+    size_t done = 0;
+    while (done < count)
+    {
+        /* Take as many keys as the limits allow */
+        size_t n = 0, key_bytes = 0, payload = 0;
+        while (done + n < count && n < BLOOM_PROTO_MAX_KEYS)
+        {
+            size_t next = sizeof(uint32_t) + keys[done + n].len;
+            if (payload + next > BLOOM_PROTO_MAX_PAYLOAD)
+                break;
+            payload += next;
+            key_bytes += keys[done + n].len;
+            n++;
+        }
+
+        if (n == 0)
+        {
+            errno = EMSGSIZE; // A single key over the payload limit
+            return -1;
+        }
+
+        /* A split that is not the last chunk must end on a bitmap word */
+        if (done + n < count && (n & 63) != 0)
+        {
+            while ((n & 63) != 0)
+            {
+                n--;
+                key_bytes -= keys[done + n].len;
+            }
+        }
+        if (n == 0)
+        {
+            /* The next 64 keys do not fit one request: query them one by one */
+            size_t word_end = count - done < 64 ? count : done + 64;
+            results[done / 64] = 0;
+            for (; done < word_end; done++)
+            {
+                uint64_t result;
+                if (sizeof(uint32_t) + keys[done].len > BLOOM_PROTO_MAX_PAYLOAD)
+                {
+                    errno = EMSGSIZE;
+                    return -1;
+                }
+                if (query_chunk(client, keys + done, 1, keys[done].len, &result) < 0)
+                    return -1;
+                results[done / 64] |= (result & 1) << (done & 63);
+            }
+            continue;
+        }
+
+        if (query_chunk(client, keys + done, (uint32_t)n, key_bytes, results + done / 64) < 0)
+            return -1;
+        done += n;
+    }
+    return 0;
+}
+
+int bloom_client_search(bloom_client_t *client, const void *key, size_t len)
+{
+    bloom_key_t k = {key, len};
+    uint64_t result;
+    if (bloom_client_query(client, &k, 1, &result) < 0)
+        return -1;
+    return (int)(result & 1);
+}
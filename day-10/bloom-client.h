@@ -0,0 +1,42 @@
+// bloom-client.h
+// -----------------------------------------------------------------------------
+// Client side of the Bloom filter membership service (bloom-server.c).
+//
+// A client owns one connection and one request buffer, so it is not
+// thread-safe: use one client per thread or process. Queries of any size are
+// split into protocol-sized requests (bloom-protocol.h) transparently.
+//
+// Build: gcc -O2 your-program.c bloom-client.c
+// -----------------------------------------------------------------------------
+
+#ifndef BLOOM_CLIENT_H
+#define BLOOM_CLIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bloom.h"
+#include "bloom-protocol.h"
+
+typedef struct
+{
+    int fd;
+    unsigned char *buffer; // Request being assembled: header, lengths, key bytes
+    size_t capacity;
+} bloom_client_t;
+
+// Connect to a server listening on path (NULL = BLOOM_SOCKET_PATH).
+// Returns NULL on error (errno set).
+bloom_client_t *bloom_client_connect(const char *path);
+void bloom_client_close(bloom_client_t *client);
+
+// Look up count keys. Bit i of results (LSB first in results[i / 64]) is set
+// when keys[i] is possibly present. results must hold (count + 63) / 64 words.
+// Returns 0 or -1 (errno set; EPROTO for a malformed or rejected reply,
+// EMSGSIZE when one key exceeds BLOOM_PROTO_MAX_PAYLOAD). Keys are sent in
+// chunks of whole bitmap words; 64 keys too big for one request go singly.
+int bloom_client_query(bloom_client_t *client, const bloom_key_t *keys, size_t count, uint64_t *results);
+
+// Single key convenience: 1 = possibly present, 0 = definitely not, -1 = error
+int bloom_client_search(bloom_client_t *client, const void *key, size_t len);
+
+#endif // BLOOM_CLIENT_H
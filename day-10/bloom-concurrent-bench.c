@@ -0,0 +1,201 @@
+/*
+ * Concurrent Bloom filter scaling benchmark
+ *
+ * One BLOOM_CONCURRENT filter is shared by 1 .. max_threads threads. Every
+ * thread runs a mixed workload (insert_percent inserts, the rest searches)
+ * for a fixed time; the benchmark reports total throughput and throughput per
+ * thread for each thread count.
+ *
+ * Each step starts from a fresh, empty filter sized for num_keys. Inserts
+ * never repeat a key within a step (8-byte keys: thread id and a per-thread
+ * counter), so they really set bits instead of finding them all set already -
+ * a re-inserted key would only cost the relaxed load that atomic_set_bits()
+ * does first. A step ends after seconds_per_step or as soon as a thread has
+ * inserted its share of num_keys, whichever comes first, so the filter never
+ * runs past its design load; pick num_keys large enough for the step to last.
+ * Searches draw from num_keys pre-generated string keys.
+ *
+ * Build: gcc -O2 -march=native -pthread bloom-concurrent-bench.c bloom.c -o bloom-concurrent-bench -lm
+ * Usage: ./bloom-concurrent-bench <max_threads> <num_keys> <insert_percent> <seconds_per_step> [blocked]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "bloom.h"
+
+#define KEY_SLOT 24 // Bytes reserved per pre-generated key
+
+static char *key_storage;
+static size_t *key_lengths;
+static uint64_t num_keys;
+static int insert_percent;
+static uint64_t insert_quota; // Per thread and step: num_keys / num_threads
+static unsigned filter_flags;
+static bloom_filter_t *filter; // Rebuilt for every step
+static volatile int stop_requested = 0;
+
+// Cache-line aligned so neighbouring threads' counters never share a line
+typedef struct
+{
+    int thread_id;
+    uint64_t inserts; // Per-thread counters, summed after join
+    uint64_t searches;
+    uint64_t hits;
+} __attribute__((aligned(64))) thread_arg_t;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64*: cheap per-thread random key choice without shared state
+static inline uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545f4914f6cdd1dULL;
+}
+
+static void *worker_thread(void *arg)
+{
+    thread_arg_t *targ = (thread_arg_t *)arg;
+    uint64_t rng = 0x9e3779b97f4a7c15ULL * (uint64_t)(targ->thread_id + 1);
+    uint64_t next_insert = (uint64_t)targ->thread_id << 48; // Unique per thread, never repeats
+
+    while (!stop_requested)
+    {
+        // Check the stop flag every 256 operations to keep it off the hot path
+        for (int iterator = 0; iterator < 256; ++iterator)
+        {
+            uint64_t r = next_random(&rng);
+
+            if ((int)((r >> 40) % 100) < insert_percent)
+            {
+                if (targ->inserts == insert_quota)
+                {
+                    stop_requested = 1; // Filter at capacity: end the step for everyone
+                    break;
+                }
+                bloom_insert(filter, &next_insert, sizeof(next_insert));
+                next_insert++;
+                targ->inserts++;
+            }
+            else
+            {
+                uint64_t index = r % num_keys;
+                targ->hits += (uint64_t)bloom_search(filter, key_storage + index * KEY_SLOT, key_lengths[index]);
+                targ->searches++;
+            }
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 5 && argc != 6)
+    {
+        fprintf(stderr, "Usage: %s <max_threads> <num_keys> <insert_percent> <seconds_per_step> [blocked]\n", argv[0]);
+        return 1;
+    }
+
+    int max_threads = atoi(argv[1]);
+    num_keys = strtoull(argv[2], NULL, 10);
+    insert_percent = atoi(argv[3]);
+    int seconds_per_step = atoi(argv[4]);
+    filter_flags = BLOOM_CONCURRENT;
+    if (argc == 6 && strcmp(argv[5], "blocked") == 0)
+        filter_flags |= BLOOM_BLOCKED;
+
+    if (max_threads <= 0 || num_keys == 0 || insert_percent < 0 || insert_percent > 100 || seconds_per_step <= 0)
+    {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+
+    key_storage = malloc(num_keys * KEY_SLOT);
+    key_lengths = malloc(num_keys * sizeof(size_t));
+    filter = bloom_create(num_keys, 0.01, filter_flags);
+    if (key_storage == NULL || key_lengths == NULL || filter == NULL)
+    {
+        perror("allocation failed");
+        return 1;
+    }
+
+    for (uint64_t iterator = 0; iterator < num_keys; ++iterator)
+    {
+        int n = snprintf(key_storage + iterator * KEY_SLOT, KEY_SLOT, "key-%lu", (unsigned long)iterator);
+        key_lengths[iterator] = (size_t)n;
+    }
+
+    printf("filter: %lu bits (%.1f MB), k = %u, %s, online CPUs = %ld\n",
+           (unsigned long)filter->num_bits, (double)filter->num_bits / 8 / 1e6, filter->num_hashes,
+           (filter_flags & BLOOM_BLOCKED) ? "blocked" : "standard", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%8s %14s %16s %10s %10s\n", "threads", "Mops/s", "Mops/s/thread", "inserts%", "seconds");
+
+    pthread_t threads[max_threads];
+    thread_arg_t args[max_threads];
+
+    for (int num_threads = 1; num_threads <= max_threads; ++num_threads)
+    {
+        /* Fresh filter: the previous step's inserts must not pre-set bits */
+        bloom_destroy(filter);
+        filter = bloom_create(num_keys, 0.01, filter_flags);
+        if (filter == NULL)
+        {
+            perror("bloom_create");
+            return 1;
+        }
+        insert_quota = num_keys / (uint64_t)num_threads;
+        stop_requested = 0;
+        for (int iterator = 0; iterator < num_threads; ++iterator)
+        {
+            memset(&args[iterator], 0, sizeof(args[iterator]));
+            args[iterator].thread_id = iterator;
+        }
+
+        double start = now_seconds();
+        for (int iterator = 0; iterator < num_threads; ++iterator)
+        {
+            if (pthread_create(&threads[iterator], NULL, worker_thread, &args[iterator]) != 0)
+            {
+                perror("pthread_create");
+                return 1;
+            }
+        }
+
+        /* Until the time is up or a thread used its insert quota */
+        struct timespec tick = {0, 1000000};
+        while (!stop_requested && now_seconds() - start < seconds_per_step)
+            nanosleep(&tick, NULL);
+        stop_requested = 1;
+
+        uint64_t inserts = 0, searches = 0;
+        for (int iterator = 0; iterator < num_threads; ++iterator)
+        {
+            pthread_join(threads[iterator], NULL);
+            inserts += args[iterator].inserts;
+            searches += args[iterator].searches;
+        }
+        double elapsed = now_seconds() - start;
+
+        double mops = (double)(inserts + searches) / elapsed / 1e6;
+        printf("%8d %14.2f %16.2f %10.1f %10.2f\n", num_threads, mops, mops / num_threads,
+               100.0 * (double)inserts / (double)(inserts + searches), elapsed);
+    }
+
+    bloom_destroy(filter);
+    free(key_lengths);
+    free(key_storage);
+    return 0;
+}
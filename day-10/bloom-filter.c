@@ -1,90 +1,303 @@
+/*
+ * Bloom filter benchmark and accuracy harness
+ *
+ * For each layout (standard, blocked):
+ * 1. Build the filter twice from the same keys: once key by key with
+ *    bloom_insert(), once with bloom_insert_batch()
+ * 2. Look up every inserted key, key by key and batched (must all hit)
+ * 3. Look up held-out keys that were never inserted and compare the
+ *    measured false-positive rate with theory:
+ *      standard:  (1 - e^(-k n / m))^k
+ *      blocked:   the same formula for one 512-bit block, averaged over
+ *                 the Poisson-distributed number of keys per block
+ * Results go to stdout as one JSON object; progress goes to stderr.
+ *
+ * Keys are "key-<i>" / "heldout-<i>" strings, or lines of a file: then the
+ * last 10% of the lines are held out (lines are assumed distinct).
+ *
+ * Build: gcc -O2 -march=native bloom-filter.c bloom.c -o bloom-filter -lm
+ * Usage: ./bloom-filter [--keys N] [--file path] [--fp rate]
+ */
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bloom.h"
 
-// 1. Defining Bit Array
-#define BLOOM_SIZE 20
-int bloom_filter[BLOOM_SIZE]; // all initialized to 0
+#define DEFAULT_KEYS 1000000
+#define DEFAULT_FP_RATE 0.01
+#define KEY_SLOT 24 // Bytes per generated key
 
-void printBloom()
+typedef struct
 {
-    for (int iterator = 0; iterator < BLOOM_SIZE; iterator++)
-    {
-        printf("%d ", bloom_filter[iterator]);
-    }
-    printf("\n");
+    double insert_ns;       // bloom_insert() per key
+    double insert_batch_ns; // bloom_insert_batch() per key
+    double search_ns;       // bloom_search() per inserted key
+    double search_batch_ns; // bloom_search_batch() per inserted key
+    double miss_ns;         // bloom_search() per held-out key
+    uint64_t false_negatives;
+    double measured_fp;
+    double theoretical_fp;
+} layout_result_t;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
 }
 
-// 2. Hash Functions
-int hashFunctionOne(char *word)
+// Generated "<prefix><i>" keys in one buffer
+static bloom_key_t *generate_keys(size_t count, const char *prefix)
 {
-    // Sum of ASCII values of characters in the word
-    int sum = 0;
-    for (int iterator = 0; word[iterator] != '\0'; iterator++)
+    bloom_key_t *keys = malloc(count * sizeof(bloom_key_t));
+    char *storage = malloc(count * KEY_SLOT);
+    if (keys == NULL || storage == NULL)
+        return NULL;
+    for (size_t iterator = 0; iterator < count; iterator++)
     {
-        sum += word[iterator]; // example: cat => 312
+        char *slot = storage + iterator * KEY_SLOT;
+        keys[iterator].data = slot;
+        keys[iterator].len = (size_t)snprintf(slot, KEY_SLOT, "%s%zu", prefix, iterator);
     }
-    return sum % BLOOM_SIZE;
+    return keys;
 }
 
-int hashFunctionTwo(char *word)
+// Keys pointing straight into an mmap of a newline-delimited file
+static bloom_key_t *load_keys(const char *path, size_t *count)
 {
-    // Weighted sum of ASCII values of characters in the word
-    int sum = 0;
-    for (int iterator = 0; word[iterator] != '\0'; iterator++)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0)
     {
-        sum += (iterator + 1) * word[iterator]; // example: cat => 641
+        close(fd);
+        return NULL;
     }
-    return sum % BLOOM_SIZE;
+    size_t size = (size_t)st.st_size;
+    const char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+
+    size_t capacity = 1024, n = 0;
+    bloom_key_t *keys = malloc(capacity * sizeof(bloom_key_t));
+    const char *p = data, *end = data + size;
+    while (keys != NULL && p < end)
+    {
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+        const char *line_end = nl ? nl : end;
+        if (line_end > p)
+        {
+            if (n == capacity)
+            {
+                capacity *= 2;
+                bloom_key_t *grown = realloc(keys, capacity * sizeof(bloom_key_t));
+                if (grown == NULL)
+                {
+                    free(keys); // realloc failure leaves the old block allocated
+                    keys = NULL;
+                    break;
+                }
+                keys = grown;
+            }
+            keys[n].data = p;
+            keys[n].len = (size_t)(line_end - p);
+            n++;
+        }
+        p = line_end + 1;
+    }
+    if (keys == NULL)
+    {
+        munmap((void *)data, size);
+        return NULL;
+    }
+    *count = n;
+    return keys;
 }
 
-// 3. Insertion
-void insert(char *word)
+static double theoretical_fp(const bloom_filter_t *bf, size_t n)
 {
-    int firstIndex = hashFunctionOne(word);
-    int secondIndex = hashFunctionTwo(word);
+    double k = (double)bf->num_hashes;
 
-    bloom_filter[firstIndex] = 1;
-    bloom_filter[secondIndex] = 1;
+    if (!(bf->flags & BLOOM_BLOCKED))
+        return pow(1.0 - exp(-k * (double)n / (double)bf->num_bits), k);
 
-    printf("Inserted %s at indices %d and %d\n", word, firstIndex, secondIndex);
-    printBloom();
+    // Keys per block ~ Poisson(lambda); sum the per-block rate over that law
+    double lambda = (double)n / (double)bf->num_blocks;
+    double total = 0.0;
+    double p = exp(-lambda); // P(i = 0)
+    int upper = (int)(lambda + 12.0 * sqrt(lambda) + 12.0);
+    for (int i = 0; i <= upper; i++)
+    {
+        double block_fp = pow(1.0 - pow(1.0 - 1.0 / BLOOM_BLOCK_BITS, k * i), k);
+        total += p * block_fp;
+        p *= lambda / (double)(i + 1);
+    }
+    return total;
 }
 
-// 4. Searching
-int search(char *word)
+static int run_layout(unsigned flags, const bloom_key_t *keys, size_t num_keys,
+                      const bloom_key_t *held_out, size_t num_held_out, double fp_rate,
+                      layout_result_t *result, bloom_filter_t **geometry)
 {
-    int firstIndex = hashFunctionOne(word);
-    int secondIndex = hashFunctionTwo(word);
+    bloom_filter_t *single = bloom_create(num_keys, fp_rate, flags);
+    bloom_filter_t *batched = bloom_create(num_keys, fp_rate, flags);
+    uint64_t *bitmap = malloc((num_keys + 63) / 64 * sizeof(uint64_t));
+    if (single == NULL || batched == NULL || bitmap == NULL)
+        return -1;
 
-    if (bloom_filter[firstIndex] == 1 && bloom_filter[secondIndex] == 1)
+    double start = now_seconds();
+    for (size_t iterator = 0; iterator < num_keys; iterator++)
     {
-        printf("\"%s\" is possibly present at positions %d %d\n",
-               word, firstIndex, secondIndex);
-        return 1; // Possibly present
+        bloom_insert(single, keys[iterator].data, keys[iterator].len);
     }
-    else
+    result->insert_ns = (now_seconds() - start) / (double)num_keys * 1e9;
+
+    start = now_seconds();
+    bloom_insert_batch(batched, keys, num_keys);
+    result->insert_batch_ns = (now_seconds() - start) / (double)num_keys * 1e9;
+
+    uint64_t hits = 0;
+    start = now_seconds();
+    for (size_t iterator = 0; iterator < num_keys; iterator++)
+    {
+        hits += (uint64_t)bloom_search(single, keys[iterator].data, keys[iterator].len);
+    }
+    result->search_ns = (now_seconds() - start) / (double)num_keys * 1e9;
+
+    start = now_seconds();
+    bloom_search_batch(batched, keys, num_keys, bitmap);
+    result->search_batch_ns = (now_seconds() - start) / (double)num_keys * 1e9;
+
+    uint64_t batch_hits = 0;
+    for (size_t iterator = 0; iterator < (num_keys + 63) / 64; iterator++)
     {
-        printf("\"%s\" is definitely not present at positions %d %d\n",
-               word, firstIndex, secondIndex);
-        return 0; // Definitely not present
+        batch_hits += (uint64_t)__builtin_popcountll(bitmap[iterator]);
     }
+    result->false_negatives = (num_keys - hits) + (num_keys - batch_hits);
+
+    uint64_t false_positives = 0;
+    start = now_seconds();
+    for (size_t iterator = 0; iterator < num_held_out; iterator++)
+    {
+        false_positives += (uint64_t)bloom_search(single, held_out[iterator].data, held_out[iterator].len);
+    }
+    result->miss_ns = (now_seconds() - start) / (double)num_held_out * 1e9;
+    result->measured_fp = (double)false_positives / (double)num_held_out;
+    result->theoretical_fp = theoretical_fp(single, num_keys);
+
+    *geometry = single;
+    bloom_destroy(batched);
+    free(bitmap);
+    return 0;
+}
+
+static void print_layout_json(const char *name, const bloom_filter_t *bf, size_t num_keys,
+                              const layout_result_t *r, int last)
+{
+    printf("    \"%s\": {\n", name);
+    printf("      \"bits\": %lu, \"hashes\": %u, \"bits_per_key\": %.3f,\n",
+           (unsigned long)bf->num_bits, bf->num_hashes, (double)bf->num_bits / (double)num_keys);
+    printf("      \"insert_ns_per_op\": %.2f, \"insert_ops_per_s\": %.0f,\n", r->insert_ns, 1e9 / r->insert_ns);
+    printf("      \"insert_batch_ns_per_op\": %.2f, \"insert_batch_ops_per_s\": %.0f,\n",
+           r->insert_batch_ns, 1e9 / r->insert_batch_ns);
+    printf("      \"search_ns_per_op\": %.2f, \"search_ops_per_s\": %.0f,\n", r->search_ns, 1e9 / r->search_ns);
+    printf("      \"search_batch_ns_per_op\": %.2f, \"search_batch_ops_per_s\": %.0f,\n",
+           r->search_batch_ns, 1e9 / r->search_batch_ns);
+    printf("      \"miss_ns_per_op\": %.2f, \"miss_ops_per_s\": %.0f,\n", r->miss_ns, 1e9 / r->miss_ns);
+    printf("      \"false_negatives\": %lu,\n", (unsigned long)r->false_negatives);
+    printf("      \"measured_fp\": %.6f, \"theoretical_fp\": %.6f\n", r->measured_fp, r->theoretical_fp);
+    printf("    }%s\n", last ? "" : ",");
 }
 
-int main()
+int main(int argc, char **argv)
 {
-    memset(bloom_filter, 0, sizeof(bloom_filter));
+    size_t num_keys = DEFAULT_KEYS;
+    double fp_rate = DEFAULT_FP_RATE;
+    const char *path = NULL;
 
-    insert("cat");
-    insert("dog");
-    insert("rat");
-    insert("bat");
+    for (int iterator = 1; iterator < argc; iterator++)
+    {
+        if (strcmp(argv[iterator], "--keys") == 0 && iterator + 1 < argc)
+            num_keys = strtoull(argv[++iterator], NULL, 10);
+        else if (strcmp(argv[iterator], "--file") == 0 && iterator + 1 < argc)
+            path = argv[++iterator];
+        else if (strcmp(argv[iterator], "--fp") == 0 && iterator + 1 < argc)
+            fp_rate = atof(argv[++iterator]);
+        else
+        {
+            fprintf(stderr, "Usage: %s [--keys N] [--file path] [--fp rate]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (num_keys == 0 || fp_rate <= 0.0 || fp_rate >= 1.0)
+    {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
 
-    search("cat");
+    bloom_key_t *keys, *held_out;
+    size_t num_held_out;
+    if (path != NULL)
+    {
+        size_t total = 0;
+        keys = load_keys(path, &total);
+        if (keys == NULL || total < 2)
+        {
+            fprintf(stderr, "%s: cannot load at least 2 keys\n", path);
+            return 1;
+        }
+        num_held_out = total / 10 ? total / 10 : 1;
+        num_keys = total - num_held_out;
+        held_out = keys + num_keys;
+    }
+    else
+    {
+        keys = generate_keys(num_keys, "key-");
+        held_out = generate_keys(num_keys, "heldout-");
+        num_held_out = num_keys;
+        if (keys == NULL || held_out == NULL)
+        {
+            perror("generate_keys");
+            return 1;
+        }
+    }
 
-    // force a false positive
-    bloom_filter[9] = 1;
-    bloom_filter[18] = 1;
-    search("cow"); 
+    const unsigned layouts[] = {BLOOM_STANDARD, BLOOM_BLOCKED};
+    const char *names[] = {"standard", "blocked"};
+    layout_result_t results[2];
+    bloom_filter_t *filters[2];
+    for (int iterator = 0; iterator < 2; iterator++)
+    {
+        fprintf(stderr, "running %s layout with %zu keys...\n", names[iterator], num_keys);
+        if (run_layout(layouts[iterator], keys, num_keys, held_out, num_held_out, fp_rate,
+                       &results[iterator], &filters[iterator]) < 0)
+        {
+            perror("run_layout");
+            return 1;
+        }
+    }
 
+    printf("{\n");
+    printf("  \"keys\": %zu,\n", num_keys);
+    printf("  \"held_out_keys\": %zu,\n", num_held_out);
+    printf("  \"source\": \"%s\",\n", path ? "file" : "generated");
+    printf("  \"target_fp\": %g,\n", fp_rate);
+    printf("  \"layouts\": {\n");
+    for (int iterator = 0; iterator < 2; iterator++)
+    {
+        print_layout_json(names[iterator], filters[iterator], num_keys, &results[iterator], iterator == 1);
+        bloom_destroy(filters[iterator]);
+    }
+    printf("  }\n");
+    printf("}\n");
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,106 @@
+// bloom-filter.hpp
+// -----------------------------------------------------------------------------
+// Header-only, compile-time sized Bloom filter for C++17.
+//
+//     BloomFilter<Bits, K, Hash>
+//
+// Same semantics as bloom.h (one 64-bit hash per key, K probes by double
+// hashing h1 + i * h2), but everything the C version decides at run time is a
+// template parameter:
+//   - Bits is a power of two, so a probe position is (h & (Bits - 1)) instead
+//     of a multiply-shift or a division
+//   - the K probes are expanded by a fold expression: no loop, no counter
+//   - storage is a std::array inside the object: no heap, no pointer chase,
+//     embeddable in other structs or placed in static memory
+//   - the empty filter is constexpr, so a static filter lives in .bss and
+//     needs no run-time initialization
+//
+// Build: g++ -std=c++17 -O2 your-program.cpp   (no .c file needed)
+// -----------------------------------------------------------------------------
+
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#include "bloom-hash.h"
+
+// Default hash: the same wyhash the C filters use
+struct BloomWyHash
+{
+    std::uint64_t operator()(const void *key, std::size_t len) const noexcept
+    {
+        return bloom_hash64(key, len, BLOOM_DEFAULT_SEED);
+    }
+};
+
+template <std::size_t Bits, unsigned K, typename Hash = BloomWyHash>
+class BloomFilter
+{
+    static_assert(Bits >= 64 && (Bits & (Bits - 1)) == 0, "Bits must be a power of two >= 64");
+    static_assert(K >= 1, "K must be at least 1");
+
+public:
+    static constexpr std::size_t num_bits = Bits;
+    static constexpr std::size_t num_words = Bits / 64;
+    static constexpr unsigned num_hashes = K;
+
+    constexpr BloomFilter() noexcept : words_{} {}
+
+    void insert(const void *key, std::size_t len) noexcept
+    {
+        std::uint64_t h1 = Hash{}(key, len);
+        insert_probes(h1, bloom_hash_step(h1), std::make_index_sequence<K>{});
+    }
+
+    void insert(std::string_view key) noexcept { insert(key.data(), key.size()); }
+
+    // true = possibly present, false = definitely not
+    bool search(const void *key, std::size_t len) const noexcept
+    {
+        std::uint64_t h1 = Hash{}(key, len);
+        return search_probes(h1, bloom_hash_step(h1), std::make_index_sequence<K>{});
+    }
+
+    bool search(std::string_view key) const noexcept { return search(key.data(), key.size()); }
+
+    void clear() noexcept { words_.fill(0); }
+
+    const std::array<std::uint64_t, num_words> &words() const noexcept { return words_; }
+
+private:
+    static constexpr std::uint64_t mask = Bits - 1;
+
+    void set_bit(std::uint64_t hash) noexcept
+    {
+        std::uint64_t bit = hash & mask;
+        words_[bit >> 6] |= std::uint64_t{1} << (bit & 63);
+    }
+
+    bool test_bit(std::uint64_t hash) const noexcept
+    {
+        std::uint64_t bit = hash & mask;
+        return (words_[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    template <std::size_t... I>
+    void insert_probes(std::uint64_t h1, std::uint64_t h2, std::index_sequence<I...>) noexcept
+    {
+        (set_bit(h1 + I * h2), ...);
+    }
+
+    // && short-circuits: stops at the first clear bit, like the C loop
+    template <std::size_t... I>
+    bool search_probes(std::uint64_t h1, std::uint64_t h2, std::index_sequence<I...>) const noexcept
+    {
+        return (test_bit(h1 + I * h2) && ...);
+    }
+
+    std::array<std::uint64_t, num_words> words_;
+};
+
+#endif // BLOOM_FILTER_HPP
@@ -0,0 +1,127 @@
+// bloom-hash.h
+// -----------------------------------------------------------------------------
+// Hashing helpers shared by the day-10 membership filters.
+//
+// bloom_hash64() is wyhash (final version 4, public domain, Wang Yi): one pass
+// over the key, a few 64x64->128 multiplies, and a well-mixed 64-bit result.
+//
+// The k probe positions are derived from that one hash by Kirsch-Mitzenmacher
+// double hashing:  g_i(x) = h1(x) + i * h2(x)  for i = 0 .. k-1
+// which gives the same asymptotic false-positive rate as k independent hashes.
+// -----------------------------------------------------------------------------
+
+#ifndef BLOOM_HASH_H
+#define BLOOM_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BLOOM_DEFAULT_SEED 0x5eed0f0b100f11e5ULL
+
+static const uint64_t wyhash_secret[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+                                          0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+// 64x64 -> 128 bit multiply, low half in *a and high half in *b
+static inline void wy_mum(uint64_t *a, uint64_t *b)
+{
+    unsigned __int128 r = (unsigned __int128)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+}
+
+static inline uint64_t wy_mix(uint64_t a, uint64_t b)
+{
+    wy_mum(&a, &b);
+    return a ^ b;
+}
+
+// Unaligned little-endian loads
+static inline uint64_t wy_read8(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t wy_read4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t wy_read3(const uint8_t *p, size_t len)
+{
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+}
+
+static inline uint64_t bloom_hash64(const void *key, size_t len, uint64_t seed)
+{
+    const uint8_t *p = (const uint8_t *)key;
+    const uint64_t *secret = wyhash_secret;
+    uint64_t a, b;
+
+    seed ^= wy_mix(seed ^ secret[0], secret[1]);
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            a = (wy_read4(p) << 32) | wy_read4(p + ((len >> 3) << 2));
+            b = (wy_read4(p + len - 4) << 32) | wy_read4(p + len - 4 - ((len >> 3) << 2));
+        }
+        else if (len > 0)
+        {
+            a = wy_read3(p, len);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t remaining = len;
+        if (remaining > 48)
+        {
+            uint64_t see1 = seed, see2 = seed;
+            do
+            {
+                seed = wy_mix(wy_read8(p) ^ secret[1], wy_read8(p + 8) ^ seed);
+                see1 = wy_mix(wy_read8(p + 16) ^ secret[2], wy_read8(p + 24) ^ see1);
+                see2 = wy_mix(wy_read8(p + 32) ^ secret[3], wy_read8(p + 40) ^ see2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (remaining > 16)
+        {
+            seed = wy_mix(wy_read8(p) ^ secret[1], wy_read8(p + 8) ^ seed);
+            remaining -= 16;
+            p += 16;
+        }
+        a = wy_read8(p + remaining - 16);
+        b = wy_read8(p + remaining - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    wy_mum(&a, &b);
+    return wy_mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+// Second, independent-looking hash for double hashing; forced odd so that
+// h1 + i * h2 never collapses onto a single value
+static inline uint64_t bloom_hash_step(uint64_t h1)
+{
+    return wy_mix(h1, wyhash_secret[2]) | 1;
+}
+
+// Map a 64-bit hash onto [0, range) without a division (Lemire's fastrange)
+static inline uint64_t bloom_reduce(uint64_t hash, uint64_t range)
+{
+    return (uint64_t)(((unsigned __int128)hash * range) >> 64);
+}
+
+#endif // BLOOM_HASH_H
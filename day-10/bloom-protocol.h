@@ -0,0 +1,56 @@
+// bloom-protocol.h
+// -----------------------------------------------------------------------------
+// Wire format of the Bloom filter membership service (bloom-server.c,
+// bloom-client.c). Local Unix domain socket, native byte order.
+//
+// Request:   bloom_request_t header
+//            uint32_t lengths[count]        length of each key
+//            key bytes, back to back        sum(lengths) bytes
+//            (payload_len = 4 * count + sum(lengths))
+//
+// Response:  bloom_response_t header
+//            uint64_t bitmap[(count + 63) / 64]   only when status == OK;
+//                                                 bit i (LSB first) set when
+//                                                 key i is possibly present
+//
+// One request carries up to BLOOM_PROTO_MAX_KEYS keys, so the syscall and
+// framing cost is paid once per batch instead of once per key. A connection
+// may send any number of requests, one at a time.
+// -----------------------------------------------------------------------------
+
+#ifndef BLOOM_PROTOCOL_H
+#define BLOOM_PROTOCOL_H
+
+#include <stdint.h>
+
+#define BLOOM_SOCKET_PATH "/tmp/bloom-server.sock"
+
+#define BLOOM_PROTO_MAGIC 0x314d4c42u // "BLM1"
+#define BLOOM_PROTO_MAX_KEYS 65536
+#define BLOOM_PROTO_MAX_PAYLOAD (64u << 20)
+
+// Operation codes
+#define BLOOM_OP_QUERY 1
+
+// Response status codes
+#define BLOOM_STATUS_OK 0
+#define BLOOM_STATUS_BAD_REQUEST 1 // Unknown op, bad magic or inconsistent lengths
+#define BLOOM_STATUS_TOO_LARGE 2   // count or payload_len over the limits
+
+typedef struct
+{
+    uint32_t magic;       // BLOOM_PROTO_MAGIC
+    uint32_t op;          // BLOOM_OP_QUERY
+    uint32_t count;       // Number of keys
+    uint32_t payload_len; // Bytes that follow this header
+} bloom_request_t;
+
+typedef struct
+{
+    uint32_t magic;  // BLOOM_PROTO_MAGIC
+    uint32_t status; // BLOOM_STATUS_*
+    uint32_t count;  // Keys answered (bitmap follows when status == OK)
+    uint32_t reserved;
+} bloom_response_t;
+
+#endif // BLOOM_PROTOCOL_H
@@ -0,0 +1,349 @@
+/*
+ * Bloom filter membership server (Unix domain socket)
+ *
+ * Holds one saved Bloom filter (bloom_save() / bloom-build) and answers
+ * batched membership queries, so many processes can share a filter without
+ * each one loading it.
+ *
+ * Steps:
+ * 1. Map the filter read-only - bloom_open()
+ * 2. Create a socket endpoint, bind, listen (same setup as uds-server.c)
+ * 3. Accept clients, one thread per connection
+ * 4. Per request: read the fixed header, then the length-prefixed payload
+ *    (bloom-protocol.h), run bloom_search_batch() over all keys, and send
+ *    the header and result bitmap back with one writev()
+ * 5. Cleanup on exit - unlink() via atexit()
+ *
+ * The filter is never written after bloom_open(), so connection threads
+ * search it without any locking.
+ *
+ * Build: gcc -O2 -march=native -pthread bloom-server.c bloom.c -o bloom-server -lm
+ * Usage: ./bloom-server <filter_file> [socket_path]
+ *   e.g. seq -f 'key-%.0f' 0 999999 > keys.txt
+ *        ./bloom-build keys.txt keys.bloom 0 0.01 4
+ *        ./bloom-server keys.bloom
+ */
+
+#define _GNU_SOURCE
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <pthread.h>
+#include <signal.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bloom.h"
+#include "bloom-protocol.h"
+
+#define BACKLOG 64 // Max pending connections
+
+static int listen_fd = -1;            // Global listening socket descriptor
+static const char *socket_path;       // Bound path, removed at exit
+static const bloom_filter_t *filter;  // Shared, read-only
+
+/* Per-connection scratch space, reused across requests */
+typedef struct
+{
+    int fd;
+    unsigned char *payload;
+    size_t payload_capacity;
+    bloom_key_t *keys;  // BLOOM_PROTO_MAX_KEYS entries
+    uint64_t *bitmap;   // BLOOM_PROTO_MAX_KEYS / 64 words
+} connection_t;
+
+/*------------------------------------------------
+  Error handler: prints message and exits program
+-------------------------------------------------*/
+static void die(const char *msg)
+{
+    perror(msg);
+    exit(EXIT_FAILURE);
+}
+
+/*------------------------------------------------
+  Cleanup function called at program exit
+  - Closes listening socket
+  - Removes socket file
+-------------------------------------------------*/
+static void cleanup(void)
+{
+    if (listen_fd != -1)
+        close(listen_fd);
+    if (socket_path != NULL)
+        unlink(socket_path);
+}
+
+/*------------------------------------------------
+  Signal handler for SIGINT/SIGTERM
+  - Exits program, triggers atexit(cleanup)
+-------------------------------------------------*/
+static void on_signal(int sig)
+{
+    (void)sig; // unused
+    exit(0);
+}
+
+/*------------------------------------------------
+  Read exactly len bytes from socket
+  - Returns 1 on success, 0 on EOF before the
+    first byte, -1 on error or EOF mid-message
+-------------------------------------------------*/
+static int read_full(int fd, void *buf, size_t len)
+{
+    char *p = (char *)buf;
+    size_t total = len;
+    while (len > 0)
+    {
+        ssize_t r = read(fd, p, len);
+        if (r == 0)
+            return len == total ? 0 : -1; // EOF
+        if (r < 0)
+        {
+            if (errno == EINTR)
+                continue; // Interrupted -> retry
+            return -1;    // Error
+        }
+        p += r;
+        len -= (size_t)r;
+    }
+    return 1;
+}
+
+/*------------------------------------------------
+  Write an iovec array completely
+  - Handles partial writes
+  - Returns 0 on success, -1 on error
+-------------------------------------------------*/
+static int writev_all(int fd, struct iovec *iov, int iovcnt)
+{
+    while (iovcnt > 0)
+    {
+        ssize_t w = writev(fd, iov, iovcnt);
+        if (w < 0)
+        {
+            if (errno == EINTR)
+                continue; // Interrupted -> retry
+            return -1;    // Error
+        }
+        while (iovcnt > 0 && (size_t)w >= iov->iov_len)
+        {
+            w -= (ssize_t)iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = (char *)iov->iov_base + w;
+            iov->iov_len -= (size_t)w;
+        }
+    }
+    return 0;
+}
+
+/*------------------------------------------------
+  Send a response header with an optional bitmap
+-------------------------------------------------*/
+static int send_response(int fd, uint32_t status, uint32_t count, const uint64_t *bitmap)
+{
+    bloom_response_t response = {BLOOM_PROTO_MAGIC, status, count, 0};
+    struct iovec iov[2];
+    iov[0].iov_base = &response;
+    iov[0].iov_len = sizeof(response);
+    iov[1].iov_base = (void *)bitmap;
+    iov[1].iov_len = status == BLOOM_STATUS_OK ? ((size_t)count + 63) / 64 * sizeof(uint64_t) : 0;
+    return writev_all(fd, iov, status == BLOOM_STATUS_OK ? 2 : 1);
+}
+
+/*------------------------------------------------
+  Handle one request
+  - Returns 0 to keep the connection, -1 to drop it
+-------------------------------------------------*/
+static int handle_request(connection_t *conn, const bloom_request_t *request)
+{
+    if (request->magic != BLOOM_PROTO_MAGIC || request->op != BLOOM_OP_QUERY)
+    {
+        send_response(conn->fd, BLOOM_STATUS_BAD_REQUEST, 0, NULL);
+        return -1; // Cannot resynchronize on an unknown stream
+    }
+    if (request->count > BLOOM_PROTO_MAX_KEYS || request->payload_len > BLOOM_PROTO_MAX_PAYLOAD)
+    {
+        send_response(conn->fd, BLOOM_STATUS_TOO_LARGE, 0, NULL);
+        return -1;
+    }
+    if (request->payload_len < (size_t)request->count * sizeof(uint32_t))
+    {
+        send_response(conn->fd, BLOOM_STATUS_BAD_REQUEST, 0, NULL); // No room for the length table
+        return -1;
+    }
+
+    /* Read the payload */
+    if (request->payload_len > conn->payload_capacity)
+    {
+        unsigned char *payload = realloc(conn->payload, request->payload_len);
+        if (payload == NULL)
+            return -1;
+        conn->payload = payload;
+        conn->payload_capacity = request->payload_len;
+    }
+    if (read_full(conn->fd, conn->payload, request->payload_len) != 1)
+        return -1;
+
+    /* Point keys into the payload and check the lengths add up */
+    const uint32_t *lengths = (const uint32_t *)conn->payload;
+    const unsigned char *bytes = conn->payload + (size_t)request->count * sizeof(uint32_t);
+    size_t remaining = request->payload_len - (size_t)request->count * sizeof(uint32_t);
+    for (uint32_t iterator = 0; iterator < request->count; iterator++)
+    {
+        if (lengths[iterator] > remaining)
+        {
+            send_response(conn->fd, BLOOM_STATUS_BAD_REQUEST, 0, NULL);
+            return -1;
+        }
+        conn->keys[iterator].data = bytes;
+        conn->keys[iterator].len = lengths[iterator];
+        bytes += lengths[iterator];
+        remaining -= lengths[iterator];
+    }
+    if (remaining != 0)
+    {
+        send_response(conn->fd, BLOOM_STATUS_BAD_REQUEST, 0, NULL);
+        return -1;
+    }
+
+    /* One batched lookup for the whole request */
+    bloom_search_batch(filter, conn->keys, request->count, conn->bitmap);
+    return send_response(conn->fd, BLOOM_STATUS_OK, request->count, conn->bitmap);
+}
+
+/*------------------------------------------------
+  Connection thread: serve requests until EOF
+-------------------------------------------------*/
+static void *connection_thread(void *arg)
+{
+    connection_t *conn = (connection_t *)arg;
+    conn->keys = malloc(BLOOM_PROTO_MAX_KEYS * sizeof(bloom_key_t));
+    conn->bitmap = malloc(BLOOM_PROTO_MAX_KEYS / 64 * sizeof(uint64_t));
+
+    if (conn->keys != NULL && conn->bitmap != NULL)
+    {
+        bloom_request_t request;
+        while (read_full(conn->fd, &request, sizeof(request)) == 1)
+        {
+            if (handle_request(conn, &request) < 0)
+                break;
+        }
+    }
+
+    close(conn->fd);
+    free(conn->payload);
+    free(conn->keys);
+    free(conn->bitmap);
+    free(conn);
+    return NULL;
+}
+
+/*------------------------------------------------
+  Main server function
+-------------------------------------------------*/
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        fprintf(stderr, "Usage: %s <filter_file> [socket_path]\n", argv[0]);
+        return 1;
+    }
+
+    /* Map the filter; verify the checksum once at start-up */
+    filter = bloom_open(argv[1], 1);
+    if (filter == NULL)
+        die("bloom_open");
+
+    /* Register cleanup function for exit */
+    atexit(cleanup);
+
+    /* Setup signal handlers; a client vanishing mid-reply must not kill us */
+    struct sigaction sa = {0};
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    /* Restrict default permissions of socket file */
+    umask(077);
+
+    /* Create listening socket */
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd == -1)
+        die("socket(AF_UNIX)");
+
+    /* Setup socket address */
+    const char *path = argc == 3 ? argv[2] : BLOOM_SOCKET_PATH;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "socket path too long: %s\n", path);
+        return 1;
+    }
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    /* Remove stale socket file */
+    unlink(path);
+
+    /* Bind socket to path */
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1)
+        die("bind");
+    socket_path = path;
+
+    /* Restrict socket permissions (owner only) */
+    if (chmod(path, 0600) == -1)
+        die("chmod(socket)");
+
+    /* Start listening */
+    if (listen(listen_fd, BACKLOG) == -1)
+        die("listen");
+
+    fprintf(stderr, "[server] %s: %lu bits, k = %u, %s layout\n", argv[1], (unsigned long)filter->num_bits,
+            filter->num_hashes, (filter->flags & BLOOM_BLOCKED) ? "blocked" : "standard");
+    fprintf(stderr, "[server] listening on %s\n", path);
+
+    /* Detached threads: nobody joins them */
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    /*-----------------------------------------
+      Main server loop: accept and hand off clients
+    ------------------------------------------*/
+    for (;;)
+    {
+        int client_fd = accept(listen_fd, NULL, NULL);
+        if (client_fd == -1)
+        {
+            if (errno == EINTR)
+                continue; // Interrupted -> retry
+            die("accept");
+        }
+
+        connection_t *conn = calloc(1, sizeof(*conn));
+        if (conn == NULL)
+        {
+            close(client_fd);
+            continue;
+        }
+        conn->fd = client_fd;
+
+        pthread_t thread;
+        if (pthread_create(&thread, &attr, connection_thread, conn) != 0)
+        {
+            perror("pthread_create");
+            close(client_fd);
+            free(conn);
+        }
+    }
+}
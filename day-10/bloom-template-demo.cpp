@@ -0,0 +1,46 @@
+// Build: g++ -std=c++17 -O2 bloom-template-demo.cpp -o bloom-template-demo
+#include <cstdio>
+#include <string>
+#include "bloom-filter.hpp"
+
+// 2^20 bits (128 KB), 7 probes: ~1% false positives at ~100k keys.
+// constexpr-constructible, so this lives in .bss with no start-up cost.
+static BloomFilter<1 << 20, 7> seen;
+
+// Small filters can be embedded directly in other structs
+struct Session
+{
+    int id;
+    BloomFilter<1024, 4> visited_pages;
+};
+
+int main()
+{
+    seen.insert("cat");
+    seen.insert("dog");
+    seen.insert("rat");
+    seen.insert("bat");
+
+    for (const char *word : {"cat", "cow"})
+    {
+        std::printf("\"%s\" is %s\n", word, seen.search(word) ? "possibly present" : "definitely not present");
+    }
+
+    // measured false-positive rate after 100k inserts
+    for (int iterator = 0; iterator < 100000; iterator++)
+    {
+        seen.insert("key-" + std::to_string(iterator));
+    }
+    int false_positives = 0;
+    for (int iterator = 0; iterator < 100000; iterator++)
+    {
+        false_positives += seen.search("absent-" + std::to_string(iterator));
+    }
+    std::printf("%d of 100000 absent keys look present\n", false_positives);
+
+    Session session{42, {}};
+    session.visited_pages.insert("/index.html");
+    std::printf("session %d visited /index.html: %s (filter is %zu bytes)\n", session.id,
+                session.visited_pages.search("/index.html") ? "possibly" : "no", sizeof(session.visited_pages));
+    return 0;
+}
@@ -0,0 +1,634 @@
+// bloom.c
+// -----------------------------------------------------------------------------
+// Packed Bloom filter implementation (see bloom.h).
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bloom.h"
+#include "bloom-hash.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define CACHE_LINE_SIZE 64
+#define BATCH_CHUNK 32 // keys hashed and prefetched ahead of resolving
+
+bloom_filter_t *bloom_create(uint64_t expected_items, double fp_rate, unsigned flags)
+{
+    if (expected_items == 0 || fp_rate <= 0.0 || fp_rate >= 1.0)
+        return NULL;
+
+    double ln2 = log(2.0);
+    double bits = -(double)expected_items * log(fp_rate) / (ln2 * ln2);
+
+    // Blocked filters round up to whole 512-bit blocks (one cache line each)
+    uint64_t num_words = ((uint64_t)ceil(bits) + 63) / 64;
+    if (flags & BLOOM_BLOCKED)
+        num_words = (num_words + BLOOM_BLOCK_WORDS - 1) / BLOOM_BLOCK_WORDS * BLOOM_BLOCK_WORDS;
+    if (num_words == 0)
+        num_words = BLOOM_BLOCK_WORDS;
+
+    uint32_t num_hashes = (uint32_t)lround(bits / (double)expected_items * ln2);
+    if (num_hashes == 0)
+        num_hashes = 1;
+
+    bloom_filter_t *bf = malloc(sizeof(*bf));
+    if (bf == NULL)
+        return NULL;
+
+    void *words = NULL;
+    if (posix_memalign(&words, CACHE_LINE_SIZE, num_words * sizeof(uint64_t)) != 0)
+    {
+        free(bf);
+        return NULL;
+    }
+    memset(words, 0, num_words * sizeof(uint64_t)); // all bits start at 0
+
+    bf->words = words;
+    bf->num_words = num_words;
+    bf->num_bits = num_words * 64;
+    bf->num_blocks = num_words / BLOOM_BLOCK_WORDS;
+    bf->num_hashes = num_hashes;
+    bf->flags = flags;
+    bf->seed = BLOOM_DEFAULT_SEED;
+    bf->mapping = NULL;
+    bf->mapping_size = 0;
+    return bf;
+}
+
+void bloom_destroy(bloom_filter_t *bf)
+{
+    if (bf == NULL)
+        return;
+    if (bf->mapping != NULL)
+        munmap(bf->mapping, bf->mapping_size);
+    else
+        free(bf->words);
+    free(bf);
+}
+
+/*------------------------------------------------
+  Standard layout: probe i is h1 + i * h2 over the
+  whole bit array (double hashing, see bloom-hash.h)
+-------------------------------------------------*/
+static void standard_insert(bloom_filter_t *bf, uint64_t h1)
+{
+    uint64_t h2 = bloom_hash_step(h1);
+    for (uint32_t iterator = 0; iterator < bf->num_hashes; iterator++)
+    {
+        uint64_t bit = bloom_reduce(h1, bf->num_bits);
+        bf->words[bit >> 6] |= 1ULL << (bit & 63);
+        h1 += h2;
+    }
+}
+
+static int standard_search(const bloom_filter_t *bf, uint64_t h1)
+{
+    uint64_t h2 = bloom_hash_step(h1);
+    for (uint32_t iterator = 0; iterator < bf->num_hashes; iterator++)
+    {
+        uint64_t bit = bloom_reduce(h1, bf->num_bits);
+        if ((bf->words[bit >> 6] & (1ULL << (bit & 63))) == 0)
+            return 0; // Definitely not present
+        h1 += h2;
+    }
+    return 1; // Possibly present
+}
+
+/*------------------------------------------------
+  Blocked layout: h1 picks one 512-bit block, the
+  k bit positions inside it come from a second
+  double-hashing sequence (top 9 bits of each step).
+  The key's bits are gathered into a 64-byte mask
+  so the block is tested/set with whole-vector ops.
+-------------------------------------------------*/
+static inline uint64_t *block_of(const bloom_filter_t *bf, uint64_t h1)
+{
+    return bf->words + bloom_reduce(h1, bf->num_blocks) * BLOOM_BLOCK_WORDS;
+}
+
+static inline void block_mask(uint32_t num_hashes, uint64_t h1, uint64_t mask[BLOOM_BLOCK_WORDS])
+{
+    uint64_t g = bloom_hash_step(h1);
+    uint64_t step = bloom_hash_step(g);
+    memset(mask, 0, BLOOM_BLOCK_WORDS * sizeof(uint64_t));
+    for (uint32_t iterator = 0; iterator < num_hashes; iterator++)
+    {
+        uint64_t bit = g >> 55; // 0 .. 511
+        mask[bit >> 6] |= 1ULL << (bit & 63);
+        g += step;
+    }
+}
+
+static void blocked_insert(bloom_filter_t *bf, uint64_t h1)
+{
+    uint64_t *block = block_of(bf, h1);
+    uint64_t mask[BLOOM_BLOCK_WORDS];
+    block_mask(bf->num_hashes, h1, mask);
+
+#if defined(__AVX2__)
+    for (int iterator = 0; iterator < BLOOM_BLOCK_WORDS; iterator += 4)
+    {
+        __m256i b = _mm256_load_si256((const __m256i *)(block + iterator));
+        __m256i m = _mm256_loadu_si256((const __m256i *)(mask + iterator));
+        _mm256_store_si256((__m256i *)(block + iterator), _mm256_or_si256(b, m));
+    }
+#elif defined(__SSE2__)
+    for (int iterator = 0; iterator < BLOOM_BLOCK_WORDS; iterator += 2)
+    {
+        __m128i b = _mm_load_si128((const __m128i *)(block + iterator));
+        __m128i m = _mm_loadu_si128((const __m128i *)(mask + iterator));
+        _mm_store_si128((__m128i *)(block + iterator), _mm_or_si128(b, m));
+    }
+#else
+    for (int iterator = 0; iterator < BLOOM_BLOCK_WORDS; iterator++)
+    {
+        block[iterator] |= mask[iterator];
+    }
+#endif
+}
+
+static int blocked_search(const bloom_filter_t *bf, uint64_t h1)
+{
+    const uint64_t *block = block_of(bf, h1);
+    uint64_t mask[BLOOM_BLOCK_WORDS];
+    block_mask(bf->num_hashes, h1, mask);
+
+#if defined(__AVX2__)
+    // testc: 1 when every bit of the mask is also set in the block
+    __m256i lo = _mm256_load_si256((const __m256i *)block);
+    __m256i hi = _mm256_load_si256((const __m256i *)(block + 4));
+    return _mm256_testc_si256(lo, _mm256_loadu_si256((const __m256i *)mask)) &
+           _mm256_testc_si256(hi, _mm256_loadu_si256((const __m256i *)(mask + 4)));
+#elif defined(__SSE2__)
+    __m128i all = _mm_set1_epi32(-1);
+    for (int iterator = 0; iterator < BLOOM_BLOCK_WORDS; iterator += 2)
+    {
+        __m128i b = _mm_load_si128((const __m128i *)(block + iterator));
+        __m128i m = _mm_loadu_si128((const __m128i *)(mask + iterator));
+        all = _mm_and_si128(all, _mm_cmpeq_epi32(_mm_and_si128(b, m), m));
+    }
+    return _mm_movemask_epi8(all) == 0xFFFF;
+#else
+    uint64_t missing = 0;
+    for (int iterator = 0; iterator < BLOOM_BLOCK_WORDS; iterator++)
+    {
+        missing |= mask[iterator] & ~block[iterator];
+    }
+    return missing == 0;
+#endif
+}
+
+/*------------------------------------------------
+  Concurrent mode (BLOOM_CONCURRENT): bits are set
+  with atomic fetch-or on the 64-bit word and read
+  with relaxed atomic loads, so any number of
+  threads can insert and search without a lock.
+  A word is only written when one of its bits is
+  still missing, which keeps hot lines shared.
+-------------------------------------------------*/
+static inline void atomic_set_bits(uint64_t *word, uint64_t bits)
+{
+    if ((__atomic_load_n(word, __ATOMIC_RELAXED) & bits) != bits)
+        __atomic_fetch_or(word, bits, __ATOMIC_RELAXED);
+}
+
+static void standard_insert_atomic(bloom_filter_t *bf, uint64_t h1)
+{
+    uint64_t h2 = bloom_hash_step(h1);
+    for (uint32_t iterator = 0; iterator < bf->num_hashes; iterator++)
+    {
+        uint64_t bit = bloom_reduce(h1, bf->num_bits);
+        atomic_set_bits(&bf->words[bit >> 6], 1ULL << (bit & 63));
+        h1 += h2;
+    }
+}
+
+static int standard_search_atomic(const bloom_filter_t *bf, uint64_t h1)
+{
+    uint64_t h2 = bloom_hash_step(h1);
+    for (uint32_t iterator = 0; iterator < bf->num_hashes; iterator++)
+    {
+        uint64_t bit = bloom_reduce(h1, bf->num_bits);
+        if ((__atomic_load_n(&bf->words[bit >> 6], __ATOMIC_RELAXED) & (1ULL << (bit & 63))) == 0)
+            return 0;
+        h1 += h2;
+    }
+    return 1;
+}
+
+static void blocked_insert_atomic(bloom_filter_t *bf, uint64_t h1)
+{
+    uint64_t *block = block_of(bf, h1);
+    uint64_t mask[BLOOM_BLOCK_WORDS];
+    block_mask(bf->num_hashes, h1, mask);
+
+    for (int iterator = 0; iterator < BLOOM_BLOCK_WORDS; iterator++)
+    {
+        if (mask[iterator] != 0)
+            atomic_set_bits(&block[iterator], mask[iterator]);
+    }
+}
+
+static int blocked_search_atomic(const bloom_filter_t *bf, uint64_t h1)
+{
+    const uint64_t *block = block_of(bf, h1);
+    uint64_t mask[BLOOM_BLOCK_WORDS];
+    block_mask(bf->num_hashes, h1, mask);
+
+    uint64_t missing = 0;
+    for (int iterator = 0; iterator < BLOOM_BLOCK_WORDS; iterator++)
+    {
+        missing |= mask[iterator] & ~__atomic_load_n(&block[iterator], __ATOMIC_RELAXED);
+    }
+    return missing == 0;
+}
+
+// Dispatch on the construction flags once the key has been hashed
+static inline void insert_hashed(bloom_filter_t *bf, uint64_t h1)
+{
+    switch (bf->flags & (BLOOM_BLOCKED | BLOOM_CONCURRENT))
+    {
+    case BLOOM_STANDARD:
+        standard_insert(bf, h1);
+        break;
+    case BLOOM_BLOCKED:
+        blocked_insert(bf, h1);
+        break;
+    case BLOOM_CONCURRENT:
+        standard_insert_atomic(bf, h1);
+        break;
+    default:
+        blocked_insert_atomic(bf, h1);
+    }
+}
+
+static inline int search_hashed(const bloom_filter_t *bf, uint64_t h1)
+{
+    switch (bf->flags & (BLOOM_BLOCKED | BLOOM_CONCURRENT))
+    {
+    case BLOOM_STANDARD:
+        return standard_search(bf, h1);
+    case BLOOM_BLOCKED:
+        return blocked_search(bf, h1);
+    case BLOOM_CONCURRENT:
+        return standard_search_atomic(bf, h1);
+    default:
+        return blocked_search_atomic(bf, h1);
+    }
+}
+
+void bloom_insert(bloom_filter_t *bf, const void *key, size_t len)
+{
+    insert_hashed(bf, bloom_hash64(key, len, bf->seed));
+}
+
+int bloom_search(const bloom_filter_t *bf, const void *key, size_t len)
+{
+    return search_hashed(bf, bloom_hash64(key, len, bf->seed));
+}
+
+/*------------------------------------------------
+  Prefetch the cache lines a key will probe
+  - rw = 1 for inserts, 0 for lookups
+-------------------------------------------------*/
+static inline void prefetch_probes(const bloom_filter_t *bf, uint64_t h1, int rw)
+{
+    if (bf->flags & BLOOM_BLOCKED)
+    {
+        if (rw)
+            __builtin_prefetch(block_of(bf, h1), 1, 3);
+        else
+            __builtin_prefetch(block_of(bf, h1), 0, 3);
+        return;
+    }
+
+    uint64_t h2 = bloom_hash_step(h1);
+    for (uint32_t iterator = 0; iterator < bf->num_hashes; iterator++)
+    {
+        const uint64_t *word = bf->words + (bloom_reduce(h1, bf->num_bits) >> 6);
+        if (rw)
+            __builtin_prefetch(word, 1, 3);
+        else
+            __builtin_prefetch(word, 0, 3);
+        h1 += h2;
+    }
+}
+
+void bloom_insert_batch(bloom_filter_t *bf, const bloom_key_t *keys, size_t count)
+{
+    uint64_t hashes[BATCH_CHUNK];
+
+    for (size_t base = 0; base < count; base += BATCH_CHUNK)
+    {
+        size_t n = count - base < BATCH_CHUNK ? count - base : BATCH_CHUNK;
+
+        for (size_t iterator = 0; iterator < n; iterator++)
+        {
+            hashes[iterator] = bloom_hash64(keys[base + iterator].data, keys[base + iterator].len, bf->seed);
+            prefetch_probes(bf, hashes[iterator], 1);
+        }
+
+        for (size_t iterator = 0; iterator < n; iterator++)
+        {
+            insert_hashed(bf, hashes[iterator]);
+        }
+    }
+}
+
+void bloom_search_batch(const bloom_filter_t *bf, const bloom_key_t *keys, size_t count, uint64_t *results)
+{
+    uint64_t hashes[BATCH_CHUNK];
+
+    memset(results, 0, (count + 63) / 64 * sizeof(uint64_t));
+    for (size_t base = 0; base < count; base += BATCH_CHUNK)
+    {
+        size_t n = count - base < BATCH_CHUNK ? count - base : BATCH_CHUNK;
+
+        for (size_t iterator = 0; iterator < n; iterator++)
+        {
+            hashes[iterator] = bloom_hash64(keys[base + iterator].data, keys[base + iterator].len, bf->seed);
+            prefetch_probes(bf, hashes[iterator], 0);
+        }
+
+        for (size_t iterator = 0; iterator < n; iterator++)
+        {
+            int present = search_hashed(bf, hashes[iterator]);
+            size_t index = base + iterator;
+            results[index >> 6] |= (uint64_t)present << (index & 63);
+        }
+    }
+}
+
+_Static_assert(sizeof(bloom_file_header_t) == 64, "file header must stay one cache line");
+
+static uint64_t checksum_words(const uint64_t *words, uint64_t num_bits)
+{
+    return bloom_hash64(words, num_bits / 8, num_bits);
+}
+
+/*------------------------------------------------
+  Write all bytes to fd
+  - Handles partial writes
+  - Returns 0 on success, -1 on error
+-------------------------------------------------*/
+static int write_all(int fd, const void *buf, size_t len)
+{
+    const char *p = (const char *)buf;
+    while (len > 0)
+    {
+        ssize_t w = write(fd, p, len);
+        if (w < 0)
+        {
+            if (errno == EINTR)
+                continue; // Interrupted -> retry
+            return -1;    // Error
+        }
+        p += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+int bloom_save(const bloom_filter_t *bf, const char *path)
+{
+    bloom_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BLOOM_FILE_MAGIC, sizeof(header.magic));
+    header.version = BLOOM_FILE_VERSION;
+    header.header_size = sizeof(header);
+    header.num_bits = bf->num_bits;
+    header.num_hashes = bf->num_hashes;
+    header.flags = bf->flags & BLOOM_BLOCKED;
+    header.seed = bf->seed;
+    header.checksum = checksum_words(bf->words, bf->num_bits);
+
+    // Temporary file next to the target so rename() stays on one filesystem
+    char tmp_path[4096];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp.%ld", path, (long)getpid()) >= (int)sizeof(tmp_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+
+    if (write_all(fd, &header, sizeof(header)) < 0 ||
+        write_all(fd, bf->words, bf->num_words * sizeof(uint64_t)) < 0 ||
+        fsync(fd) < 0)
+    {
+        int saved = errno;
+        close(fd);
+        unlink(tmp_path);
+        errno = saved;
+        return -1;
+    }
+    if (close(fd) < 0 || rename(tmp_path, path) < 0)
+    {
+        int saved = errno;
+        unlink(tmp_path);
+        errno = saved;
+        return -1;
+    }
+
+    // Persist the rename itself by syncing the containing directory
+    char dir_path[4096];
+    const char *slash = strrchr(path, '/');
+    if (slash == NULL)
+        strcpy(dir_path, ".");
+    else if (slash == path)
+        strcpy(dir_path, "/");
+    else
+        snprintf(dir_path, sizeof(dir_path), "%.*s", (int)(slash - path), path);
+
+    int dir_fd = open(dir_path, O_RDONLY);
+    if (dir_fd >= 0)
+    {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    return 0;
+}
+
+bloom_filter_t *bloom_open(const char *path, int verify)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    if ((size_t)st.st_size < sizeof(bloom_file_header_t))
+    {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file referenced
+    if (mapping == MAP_FAILED)
+        return NULL;
+
+    const bloom_file_header_t *header = (const bloom_file_header_t *)mapping;
+    if (memcmp(header->magic, BLOOM_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != BLOOM_FILE_VERSION ||
+        header->header_size != sizeof(bloom_file_header_t) ||
+        header->num_bits == 0 || header->num_bits % 64 != 0 || header->num_hashes == 0 ||
+        (header->flags & BLOOM_BLOCKED && header->num_bits % BLOOM_BLOCK_BITS != 0) ||
+        size != sizeof(bloom_file_header_t) + header->num_bits / 8)
+    {
+        munmap(mapping, size);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    const uint64_t *words = (const uint64_t *)((const char *)mapping + sizeof(bloom_file_header_t));
+    if (verify && checksum_words(words, header->num_bits) != header->checksum)
+    {
+        munmap(mapping, size);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    // Probes are random: read-ahead would only pull in pages nobody asked for
+    madvise(mapping, size, MADV_RANDOM);
+
+    bloom_filter_t *bf = malloc(sizeof(*bf));
+    if (bf == NULL)
+    {
+        munmap(mapping, size);
+        return NULL;
+    }
+    bf->words = (uint64_t *)words; // read-only mapping: writes fault
+    bf->num_words = header->num_bits / 64;
+    bf->num_bits = header->num_bits;
+    bf->num_blocks = bf->num_words / BLOOM_BLOCK_WORDS;
+    bf->num_hashes = header->num_hashes;
+    bf->flags = header->flags & BLOOM_BLOCKED;
+    bf->seed = header->seed;
+    bf->mapping = mapping;
+    bf->mapping_size = size;
+    return bf;
+}
+
+static int same_geometry(const bloom_filter_t *a, const bloom_filter_t *b)
+{
+    return a->num_bits == b->num_bits && a->num_hashes == b->num_hashes && a->seed == b->seed &&
+           (a->flags & BLOOM_BLOCKED) == (b->flags & BLOOM_BLOCKED);
+}
+
+/*------------------------------------------------
+  dst[i] |= src[i] / dst[i] &= src[i] for words
+  [begin, end): scalar up to a cache-line boundary
+  (dst is 64-byte aligned), then whole vectors,
+  then the scalar tail
+-------------------------------------------------*/
+static void merge_or(uint64_t *dst, const uint64_t *src, uint64_t begin, uint64_t end)
+{
+    uint64_t iterator = begin;
+    for (; iterator < end && (iterator & 7) != 0; iterator++)
+        dst[iterator] |= src[iterator];
+
+#if defined(__AVX2__)
+    for (; iterator + 4 <= end; iterator += 4)
+    {
+        __m256i d = _mm256_load_si256((const __m256i *)(dst + iterator));
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + iterator));
+        _mm256_store_si256((__m256i *)(dst + iterator), _mm256_or_si256(d, s));
+    }
+#elif defined(__SSE2__)
+    for (; iterator + 2 <= end; iterator += 2)
+    {
+        __m128i d = _mm_load_si128((const __m128i *)(dst + iterator));
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + iterator));
+        _mm_store_si128((__m128i *)(dst + iterator), _mm_or_si128(d, s));
+    }
+#endif
+
+    for (; iterator < end; iterator++)
+        dst[iterator] |= src[iterator];
+}
+
+static void merge_and(uint64_t *dst, const uint64_t *src, uint64_t begin, uint64_t end)
+{
+    uint64_t iterator = begin;
+    for (; iterator < end && (iterator & 7) != 0; iterator++)
+        dst[iterator] &= src[iterator];
+
+#if defined(__AVX2__)
+    for (; iterator + 4 <= end; iterator += 4)
+    {
+        __m256i d = _mm256_load_si256((const __m256i *)(dst + iterator));
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + iterator));
+        _mm256_store_si256((__m256i *)(dst + iterator), _mm256_and_si256(d, s));
+    }
+#elif defined(__SSE2__)
+    for (; iterator + 2 <= end; iterator += 2)
+    {
+        __m128i d = _mm_load_si128((const __m128i *)(dst + iterator));
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + iterator));
+        _mm_store_si128((__m128i *)(dst + iterator), _mm_and_si128(d, s));
+    }
+#endif
+
+    for (; iterator < end; iterator++)
+        dst[iterator] &= src[iterator];
+}
+
+int bloom_union_range(bloom_filter_t *dst, const bloom_filter_t *src, uint64_t begin, uint64_t end)
+{
+    if (!same_geometry(dst, src) || begin > end || end > dst->num_words)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    merge_or(dst->words, src->words, begin, end);
+    return 0;
+}
+
+int bloom_intersect_range(bloom_filter_t *dst, const bloom_filter_t *src, uint64_t begin, uint64_t end)
+{
+    if (!same_geometry(dst, src) || begin > end || end > dst->num_words)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    merge_and(dst->words, src->words, begin, end);
+    return 0;
+}
+
+int bloom_union(bloom_filter_t *dst, const bloom_filter_t *src)
+{
+    return bloom_union_range(dst, src, 0, dst->num_words);
+}
+
+int bloom_intersect(bloom_filter_t *dst, const bloom_filter_t *src)
+{
+    return bloom_intersect_range(dst, src, 0, dst->num_words);
+}
+
+void bloom_print(const bloom_filter_t *bf)
+{
+    for (uint64_t iterator = 0; iterator < bf->num_bits; iterator++)
+    {
+        printf("%d", (int)((bf->words[iterator >> 6] >> (iterator & 63)) & 1));
+    }
+    printf("\n");
+}
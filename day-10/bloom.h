@@ -0,0 +1,128 @@
+// bloom.h
+// -----------------------------------------------------------------------------
+// Reusable Bloom filter backed by a packed bit array of 64-bit words.
+//
+// The filter is sized from the expected number of items (n) and the target
+// false-positive rate (p):
+//     m = -n * ln(p) / (ln 2)^2      (number of bits, rounded up to 64)
+//     k = (m / n) * ln 2             (number of hash functions)
+//
+// Each key is hashed once with a 64-bit wyhash; the k bit positions come from
+// double hashing (see bloom-hash.h).
+//
+// Layouts (chosen at construction with the flags argument):
+//   BLOOM_STANDARD    k bits spread over the whole array: k cache misses/lookup
+//   BLOOM_BLOCKED     all k bits of a key inside one 64-byte block: one cache
+//                     miss per lookup, tested with SSE2/AVX2 when available.
+//                     Slightly higher false-positive rate for the same size.
+// Either layout may be combined with:
+//   BLOOM_CONCURRENT  many threads insert and search one filter without a
+//                     lock: bits are set with atomic fetch-or on 64-bit words
+//                     and read with relaxed loads. A search racing with the
+//                     insert of the same key may miss it; once the inserting
+//                     thread is joined (or otherwise synchronized with) the
+//                     key is always found.
+//
+// Build: gcc -O2 your-program.c bloom.c -lm       (add -mavx2 or -march=native
+//        to use the AVX2 block probe; SSE2 is the x86-64 baseline)
+// -----------------------------------------------------------------------------
+
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLOOM_BLOCK_BITS 512 // One cache line
+#define BLOOM_BLOCK_WORDS (BLOOM_BLOCK_BITS / 64)
+
+// Construction flags
+#define BLOOM_STANDARD 0x0
+#define BLOOM_BLOCKED 0x1
+#define BLOOM_CONCURRENT 0x2
+
+typedef struct
+{
+    uint64_t *words;     // Packed bit array: bit i lives in words[i / 64], 64-byte aligned
+    uint64_t num_words;  // Number of 64-bit words in the array
+    uint64_t num_bits;   // m = num_words * 64
+    uint64_t num_blocks; // num_words / BLOOM_BLOCK_WORDS (BLOOM_BLOCKED only)
+    uint32_t num_hashes; // k
+    unsigned flags;      // BLOOM_* construction flags
+    uint64_t seed;       // Hash seed (BLOOM_DEFAULT_SEED unless loaded from a file)
+    void *mapping;       // Non-NULL when words point into a bloom_open() mapping
+    size_t mapping_size;
+} bloom_filter_t;
+
+// On-disk format (native little-endian), written by bloom_save():
+//   [bloom_file_header_t, 64 bytes][num_bits / 8 bytes of words]
+// The header is one cache line, so the mapped bit array stays 64-byte aligned.
+#define BLOOM_FILE_MAGIC "BLOOMF\0\0"
+#define BLOOM_FILE_VERSION 1
+
+typedef struct
+{
+    char magic[8];        // BLOOM_FILE_MAGIC
+    uint32_t version;     // BLOOM_FILE_VERSION
+    uint32_t header_size; // sizeof(bloom_file_header_t)
+    uint64_t num_bits;
+    uint32_t num_hashes;
+    uint32_t flags;       // Layout flags (BLOOM_BLOCKED); BLOOM_CONCURRENT is not stored
+    uint64_t seed;
+    uint64_t checksum;    // bloom_hash64() of the bit array, seeded with num_bits
+    uint8_t reserved[16];
+} bloom_file_header_t;
+
+// One key of a batch: arbitrary bytes, not necessarily NUL-terminated
+typedef struct
+{
+    const void *data;
+    size_t len;
+} bloom_key_t;
+
+// Allocate an empty filter sized for expected_items at fp_rate (0 < p < 1).
+// With BLOOM_BLOCKED the bit array is rounded up to whole 64-byte blocks.
+// Returns NULL on invalid arguments or allocation failure.
+bloom_filter_t *bloom_create(uint64_t expected_items, double fp_rate, unsigned flags);
+void bloom_destroy(bloom_filter_t *bf);
+
+// Keys are arbitrary byte strings (pointer + length).
+void bloom_insert(bloom_filter_t *bf, const void *key, size_t len);
+int bloom_search(const bloom_filter_t *bf, const void *key, size_t len); // 1 = possibly present, 0 = definitely not
+
+// Batched variants: hash a chunk of keys, prefetch every cache line the chunk
+// will touch, then resolve the probes so the memory misses overlap.
+// search_batch writes bit i of results (LSB-first 64-bit words, caller supplies
+// (count + 63) / 64 words) to 1 if keys[i] is possibly present.
+void bloom_insert_batch(bloom_filter_t *bf, const bloom_key_t *keys, size_t count);
+void bloom_search_batch(const bloom_filter_t *bf, const bloom_key_t *keys, size_t count, uint64_t *results);
+
+// Write the filter to path atomically: a temporary file in the same directory
+// is written and fsync'd, then renamed over path. Returns 0 or -1 (errno set).
+int bloom_save(const bloom_filter_t *bf, const char *path);
+
+// Map a saved filter read-only. Nothing is copied or parsed beyond the header:
+// pages fault in on first probe and are shared through the page cache with
+// every other process mapping the same file. With verify != 0 the checksum is
+// recomputed first (reads the whole file). The result is read-only: only
+// search functions may be used on it. Release it with bloom_destroy().
+// Returns NULL on error (errno set; EINVAL for a malformed file).
+bloom_filter_t *bloom_open(const char *path, int verify);
+
+// Set operations on filters of identical geometry (same num_bits, num_hashes,
+// seed and layout, e.g. created by identical bloom_create() calls):
+//   union:      dst |= src  -> a key inserted into either is found in dst
+//   intersect:  dst &= src  -> approximates the intersection (may keep more
+//                              false positives than a filter built from it)
+// The _range variants touch only words [begin, end) so several threads can
+// merge disjoint slices in parallel. Return 0, or -1 (errno = EINVAL) when
+// the geometries differ.
+int bloom_union(bloom_filter_t *dst, const bloom_filter_t *src);
+int bloom_intersect(bloom_filter_t *dst, const bloom_filter_t *src);
+int bloom_union_range(bloom_filter_t *dst, const bloom_filter_t *src, uint64_t begin, uint64_t end);
+int bloom_intersect_range(bloom_filter_t *dst, const bloom_filter_t *src, uint64_t begin, uint64_t end);
+
+// Print the bit array (only useful for tiny demo filters).
+void bloom_print(const bloom_filter_t *bf);
+
+#endif // BLOOM_H
@@ -0,0 +1,54 @@
+// Build: gcc -O2 counting-bloom-filter.c counting-bloom.c -o counting-bloom-filter -lm
+#include <stdio.h>
+#include <string.h>
+#include "counting-bloom.h"
+
+#define EXPECTED_ITEMS 4
+#define FP_RATE 0.01
+
+void search(counting_bloom_t *cbf, char *word)
+{
+    if (counting_bloom_search(cbf, word, strlen(word)))
+        printf("\"%s\" is possibly present\n", word);
+    else
+        printf("\"%s\" is definitely not present\n", word);
+}
+
+int main()
+{
+    counting_bloom_t *cbf = counting_bloom_create(EXPECTED_ITEMS, FP_RATE);
+    if (cbf == NULL)
+    {
+        perror("counting_bloom_create failed");
+        return 1;
+    }
+    printf("Filter: %lu counters (%lu bytes), %u hash functions\n",
+           (unsigned long)cbf->num_counters, (unsigned long)(cbf->num_words * 8), cbf->num_hashes);
+
+    counting_bloom_insert(cbf, "cat", 3);
+    counting_bloom_insert(cbf, "dog", 3);
+    counting_bloom_insert(cbf, "rat", 3);
+    counting_bloom_insert(cbf, "bat", 3);
+
+    search(cbf, "cat");
+
+    // unlike the plain filter, keys can be removed again
+    counting_bloom_remove(cbf, "cat", 3);
+    search(cbf, "cat");
+    search(cbf, "dog");
+
+    if (counting_bloom_remove(cbf, "cow", 3) < 0)
+        printf("\"cow\" was never inserted, nothing removed\n");
+
+    // the same key inserted 20 times drives its counters past 15
+    int saturated = 0;
+    for (int iterator = 0; iterator < 20; iterator++)
+    {
+        saturated += counting_bloom_insert(cbf, "owl", 3);
+    }
+    printf("Inserting \"owl\" 20 times saturated %d counters (%lu in total)\n",
+           saturated, (unsigned long)cbf->saturated_counters);
+
+    counting_bloom_destroy(cbf);
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * counting_bloom_remove() regression check
+ *
+ * Removing a false-positive key must never touch counters it does not probe.
+ * The dangerous case: a key whose probes hit the same counter twice while
+ * that counter holds 1. The first decrement drains it to 0; a second,
+ * unchecked decrement would borrow out of the nibble and corrupt the next
+ * counter in the word.
+ *
+ * Fills a tiny filter until such a key shows up, removes it, and compares
+ * every counter before and after. Exit status 0 = pass.
+ *
+ * Build: gcc -O2 counting-bloom-test.c counting-bloom.c -o counting-bloom-test -lm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "counting-bloom.h"
+#include "bloom-hash.h"
+
+#define MAX_PROBES 32
+
+static unsigned counter_at(const uint64_t *words, uint64_t index)
+{
+    return (unsigned)(words[index >> 4] >> ((index & 15) * 4)) & 0xF;
+}
+
+// The counter indexes key probes, as counting-bloom.c computes them
+static void probes_of(const counting_bloom_t *cbf, const char *key, uint64_t *indexes)
+{
+    uint64_t h1 = bloom_hash64(key, strlen(key), cbf->seed);
+    uint64_t h2 = bloom_hash_step(h1);
+    for (uint32_t iterator = 0; iterator < cbf->num_hashes; iterator++)
+    {
+        indexes[iterator] = bloom_reduce(h1, cbf->num_counters);
+        h1 += h2;
+    }
+}
+
+/*
+ * A key that was not inserted, is a false positive, and probes one counter
+ * that holds 1 at least twice. Returns 1 and fills key if found.
+ */
+static int find_draining_key(const counting_bloom_t *cbf, int inserted, char *key, size_t size)
+{
+    uint64_t indexes[MAX_PROBES];
+    for (int candidate = inserted; candidate < inserted + 100000; ++candidate)
+    {
+        snprintf(key, size, "key-%d", candidate);
+        if (!counting_bloom_search(cbf, key, strlen(key)))
+            continue;
+        probes_of(cbf, key, indexes);
+        for (uint32_t first = 0; first < cbf->num_hashes; ++first)
+        {
+            for (uint32_t second = first + 1; second < cbf->num_hashes; ++second)
+            {
+                if (indexes[first] == indexes[second] && counter_at(cbf->words, indexes[first]) == 1)
+                    return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    counting_bloom_t *cbf = counting_bloom_create(4, 0.01);
+    if (cbf == NULL || cbf->num_hashes > MAX_PROBES)
+    {
+        perror("counting_bloom_create failed");
+        return 1;
+    }
+
+    /* Insert key-0, key-1, ... until some other key drains a counter */
+    char key[32], inserted_key[32];
+    int inserted = 0;
+    while (!find_draining_key(cbf, inserted, key, sizeof(key)))
+    {
+        if (inserted == 1000)
+        {
+            fprintf(stderr, "no suitable false positive found\n");
+            return 1;
+        }
+        snprintf(inserted_key, sizeof(inserted_key), "key-%d", inserted++);
+        counting_bloom_insert(cbf, inserted_key, strlen(inserted_key));
+    }
+
+    uint64_t *before = malloc(cbf->num_words * sizeof(uint64_t));
+    if (before == NULL)
+        return 1;
+    memcpy(before, cbf->words, cbf->num_words * sizeof(uint64_t));
+    uint64_t indexes[MAX_PROBES];
+    probes_of(cbf, key, indexes);
+
+    if (counting_bloom_remove(cbf, key, strlen(key)) != 0)
+    {
+        fprintf(stderr, "\"%s\" was a false positive but remove refused it\n", key);
+        return 1;
+    }
+
+    /* Probed counters may only go down; all others must be unchanged */
+    int failures = 0;
+    for (uint64_t index = 0; index < cbf->num_counters; ++index)
+    {
+        int probed = 0;
+        for (uint32_t iterator = 0; iterator < cbf->num_hashes; ++iterator)
+        {
+            probed |= indexes[iterator] == index;
+        }
+        unsigned old_value = counter_at(before, index), new_value = counter_at(cbf->words, index);
+        if (probed ? new_value > old_value : new_value != old_value)
+        {
+            fprintf(stderr, "counter %lu: %u -> %u (%s)\n", (unsigned long)index, old_value, new_value,
+                    probed ? "probed" : "not probed");
+            failures++;
+        }
+    }
+
+    printf("%d keys inserted, removed false positive \"%s\": %s\n", inserted, key, failures == 0 ? "PASS" : "FAIL");
+    free(before);
+    counting_bloom_destroy(cbf);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+// counting-bloom.c
+// -----------------------------------------------------------------------------
+// Counting Bloom filter with packed 4-bit saturating counters (see counting-bloom.h).
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <math.h>
+#include "counting-bloom.h"
+#include "bloom-hash.h"
+
+counting_bloom_t *counting_bloom_create(uint64_t expected_items, double fp_rate)
+{
+    if (expected_items == 0 || fp_rate <= 0.0 || fp_rate >= 1.0)
+        return NULL;
+
+    double ln2 = log(2.0);
+    double counters = -(double)expected_items * log(fp_rate) / (ln2 * ln2);
+    uint64_t num_words = ((uint64_t)ceil(counters) + 15) / 16;
+    if (num_words == 0)
+        num_words = 1;
+
+    uint32_t num_hashes = (uint32_t)lround(counters / (double)expected_items * ln2);
+    if (num_hashes == 0)
+        num_hashes = 1;
+
+    counting_bloom_t *cbf = malloc(sizeof(*cbf));
+    if (cbf == NULL)
+        return NULL;
+
+    cbf->words = calloc(num_words, sizeof(uint64_t)); // all counters start at 0
+    if (cbf->words == NULL)
+    {
+        free(cbf);
+        return NULL;
+    }
+    cbf->num_words = num_words;
+    cbf->num_counters = num_words * 16;
+    cbf->num_hashes = num_hashes;
+    cbf->seed = BLOOM_DEFAULT_SEED;
+    cbf->saturated_counters = 0;
+    return cbf;
+}
+
+void counting_bloom_destroy(counting_bloom_t *cbf)
+{
+    if (cbf == NULL)
+        return;
+    free(cbf->words);
+    free(cbf);
+}
+
+static inline unsigned get_counter(const counting_bloom_t *cbf, uint64_t index)
+{
+    return (unsigned)(cbf->words[index >> 4] >> ((index & 15) * 4)) & 0xF;
+}
+
+// Adding/subtracting 1 << shift moves only this nibble because callers check
+// the counter first: increment only below 15, decrement only above 0 (a
+// borrow out of a zero nibble would corrupt the next counter)
+static inline void add_counter(counting_bloom_t *cbf, uint64_t index, int delta)
+{
+    uint64_t one = 1ULL << ((index & 15) * 4);
+    if (delta > 0)
+        cbf->words[index >> 4] += one;
+    else
+        cbf->words[index >> 4] -= one;
+}
+
+int counting_bloom_insert(counting_bloom_t *cbf, const void *key, size_t len)
+{
+    uint64_t h1 = bloom_hash64(key, len, cbf->seed);
+    uint64_t h2 = bloom_hash_step(h1);
+    int saturated = 0;
+
+    for (uint32_t iterator = 0; iterator < cbf->num_hashes; iterator++)
+    {
+        uint64_t index = bloom_reduce(h1, cbf->num_counters);
+        unsigned value = get_counter(cbf, index);
+        if (value < COUNTING_BLOOM_MAX)
+        {
+            add_counter(cbf, index, 1);
+            if (value + 1 == COUNTING_BLOOM_MAX)
+            {
+                cbf->saturated_counters++;
+                saturated++;
+            }
+        }
+        h1 += h2;
+    }
+    return saturated;
+}
+
+int counting_bloom_remove(counting_bloom_t *cbf, const void *key, size_t len)
+{
+    uint64_t h1 = bloom_hash64(key, len, cbf->seed);
+    uint64_t h2 = bloom_hash_step(h1);
+
+    // First pass: refuse to touch anything unless every counter is non-zero
+    if (!counting_bloom_search(cbf, key, len))
+        return -1;
+
+    for (uint32_t iterator = 0; iterator < cbf->num_hashes; iterator++)
+    {
+        uint64_t index = bloom_reduce(h1, cbf->num_counters);
+        // Re-read per probe: a false positive whose probes repeat an index
+        // can drain that counter to 0 before its last probe. Saturated
+        // counters stick.
+        unsigned value = get_counter(cbf, index);
+        if (value > 0 && value < COUNTING_BLOOM_MAX)
+            add_counter(cbf, index, -1);
+        h1 += h2;
+    }
+    return 0;
+}
+
+int counting_bloom_search(const counting_bloom_t *cbf, const void *key, size_t len)
+{
+    uint64_t h1 = bloom_hash64(key, len, cbf->seed);
+    uint64_t h2 = bloom_hash_step(h1);
+
+    for (uint32_t iterator = 0; iterator < cbf->num_hashes; iterator++)
+    {
+        if (get_counter(cbf, bloom_reduce(h1, cbf->num_counters)) == 0)
+            return 0; // Definitely not present
+        h1 += h2;
+    }
+    return 1; // Possibly present
+}
@@ -0,0 +1,48 @@
+// counting-bloom.h
+// -----------------------------------------------------------------------------
+// Counting Bloom filter: like bloom.h, but every position is a 4-bit
+// saturating counter instead of a bit, so keys can be removed again.
+//
+// Sixteen counters are packed into each 64-bit word. A counter that reaches 15
+// sticks there: it is never decremented, because its true count is unknown and
+// decrementing it could create false negatives. Saturations are reported by
+// counting_bloom_insert() and counted in saturated_counters.
+//
+// Sizing and hashing are the same as bloom.h (m positions, k probes by double
+// hashing of one wyhash), so memory use is 4x a plain filter of the same rate.
+//
+// Build: gcc -O2 your-program.c counting-bloom.c -lm
+// -----------------------------------------------------------------------------
+
+#ifndef COUNTING_BLOOM_H
+#define COUNTING_BLOOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define COUNTING_BLOOM_MAX 15 // Saturation value of a 4-bit counter
+
+typedef struct
+{
+    uint64_t *words;             // 16 counters per word: counter i in bits 4*(i%16) .. +3 of words[i / 16]
+    uint64_t num_words;
+    uint64_t num_counters;       // m = num_words * 16
+    uint32_t num_hashes;         // k
+    uint64_t seed;
+    uint64_t saturated_counters; // Counters stuck at COUNTING_BLOOM_MAX
+} counting_bloom_t;
+
+counting_bloom_t *counting_bloom_create(uint64_t expected_items, double fp_rate);
+void counting_bloom_destroy(counting_bloom_t *cbf);
+
+// Returns the number of counters this insert saturated (0 in the normal case).
+int counting_bloom_insert(counting_bloom_t *cbf, const void *key, size_t len);
+
+// Returns 0 on success, -1 if the key is definitely not present (nothing changed).
+// Removing a key that was never inserted but is a false positive corrupts the
+// filter, exactly as with any counting Bloom filter.
+int counting_bloom_remove(counting_bloom_t *cbf, const void *key, size_t len);
+
+int counting_bloom_search(const counting_bloom_t *cbf, const void *key, size_t len); // 1 = possibly present
+
+#endif // COUNTING_BLOOM_H
@@ -0,0 +1,209 @@
+// cuckoo-filter.c
+// -----------------------------------------------------------------------------
+// Cuckoo filter with packed 12-bit fingerprints (see cuckoo-filter.h).
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "cuckoo-filter.h"
+#include "bloom-hash.h"
+
+#define FINGERPRINT_MASK ((1u << CUCKOO_FINGERPRINT_BITS) - 1)
+#define BUCKET_MASK ((1ULL << (CUCKOO_SLOTS * CUCKOO_FINGERPRINT_BITS)) - 1)
+#define TABLE_PADDING 2 // Lets the last bucket be read with one 8-byte load
+
+cuckoo_filter_t *cuckoo_create(uint64_t capacity)
+{
+    if (capacity == 0)
+        return NULL;
+
+    uint64_t num_buckets = (uint64_t)ceil((double)capacity / (CUCKOO_SLOTS * CUCKOO_LOAD_FACTOR));
+
+    cuckoo_filter_t *cf = calloc(1, sizeof(*cf));
+    if (cf == NULL)
+        return NULL;
+
+    cf->table = calloc(num_buckets * CUCKOO_BUCKET_BYTES + TABLE_PADDING, 1); // 0 = empty slot
+    if (cf->table == NULL)
+    {
+        free(cf);
+        return NULL;
+    }
+    cf->num_buckets = num_buckets;
+    cf->seed = BLOOM_DEFAULT_SEED;
+    cf->rng = 0x9e3779b97f4a7c15ULL;
+    return cf;
+}
+
+void cuckoo_destroy(cuckoo_filter_t *cf)
+{
+    if (cf == NULL)
+        return;
+    free(cf->table);
+    free(cf);
+}
+
+static inline uint64_t load_bucket(const cuckoo_filter_t *cf, uint64_t bucket)
+{
+    uint64_t v;
+    memcpy(&v, cf->table + bucket * CUCKOO_BUCKET_BYTES, 8);
+    return v & BUCKET_MASK;
+}
+
+// Writes back only the bucket's own 6 bytes (little-endian)
+static inline void store_bucket(cuckoo_filter_t *cf, uint64_t bucket, uint64_t v)
+{
+    memcpy(cf->table + bucket * CUCKOO_BUCKET_BYTES, &v, CUCKOO_BUCKET_BYTES);
+}
+
+static inline unsigned get_slot(uint64_t v, int slot)
+{
+    return (unsigned)(v >> (slot * CUCKOO_FINGERPRINT_BITS)) & FINGERPRINT_MASK;
+}
+
+static inline uint64_t set_slot(uint64_t v, int slot, unsigned fp)
+{
+    int shift = slot * CUCKOO_FINGERPRINT_BITS;
+    return (v & ~((uint64_t)FINGERPRINT_MASK << shift)) | ((uint64_t)fp << shift);
+}
+
+// Fingerprint from the low bits (the bucket index uses the high bits); never 0
+static inline unsigned fingerprint_of(uint64_t hash)
+{
+    unsigned fp = (unsigned)hash & FINGERPRINT_MASK;
+    return fp ? fp : 1;
+}
+
+// j = (H(fp) - i) mod m: applying it twice gives i back
+static inline uint64_t alt_bucket(const cuckoo_filter_t *cf, uint64_t bucket, unsigned fp)
+{
+    uint64_t t = bloom_reduce((uint64_t)fp * 0x9e3779b97f4a7c15ULL, cf->num_buckets);
+    return t >= bucket ? t - bucket : t + cf->num_buckets - bucket;
+}
+
+static int bucket_contains(uint64_t v, unsigned fp)
+{
+    for (int slot = 0; slot < CUCKOO_SLOTS; slot++)
+    {
+        if (get_slot(v, slot) == fp)
+            return 1;
+    }
+    return 0;
+}
+
+// Put fp in a free slot of bucket; returns 0, or -1 if the bucket is full
+static int try_place(cuckoo_filter_t *cf, uint64_t bucket, unsigned fp)
+{
+    uint64_t v = load_bucket(cf, bucket);
+    for (int slot = 0; slot < CUCKOO_SLOTS; slot++)
+    {
+        if (get_slot(v, slot) == 0)
+        {
+            store_bucket(cf, bucket, set_slot(v, slot, fp));
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int cuckoo_insert(cuckoo_filter_t *cf, const void *key, size_t len)
+{
+    if (cf->victim != 0)
+        return -1; // Full: the last failed insert is still homeless
+
+    uint64_t hash = bloom_hash64(key, len, cf->seed);
+    unsigned fp = fingerprint_of(hash);
+    uint64_t bucket = bloom_reduce(hash, cf->num_buckets);
+
+    if (try_place(cf, bucket, fp) == 0 || try_place(cf, bucket = alt_bucket(cf, bucket, fp), fp) == 0)
+    {
+        cf->count++;
+        return 0;
+    }
+
+    // Both buckets full: evict a random resident and move it to its other bucket
+    for (int kick = 0; kick < CUCKOO_MAX_KICKS; kick++)
+    {
+        cf->rng ^= cf->rng << 13;
+        cf->rng ^= cf->rng >> 7;
+        cf->rng ^= cf->rng << 17;
+        int slot = (int)(cf->rng % CUCKOO_SLOTS);
+
+        uint64_t v = load_bucket(cf, bucket);
+        unsigned evicted = get_slot(v, slot);
+        store_bucket(cf, bucket, set_slot(v, slot, fp));
+        fp = evicted;
+
+        bucket = alt_bucket(cf, bucket, fp);
+        if (try_place(cf, bucket, fp) == 0)
+        {
+            cf->count++;
+            return 0;
+        }
+    }
+
+    // Keep the displaced fingerprint so no previously inserted key is lost
+    cf->victim = (uint16_t)fp;
+    cf->victim_bucket = bucket;
+    cf->count++;
+    return -1;
+}
+
+int cuckoo_remove(cuckoo_filter_t *cf, const void *key, size_t len)
+{
+    uint64_t hash = bloom_hash64(key, len, cf->seed);
+    unsigned fp = fingerprint_of(hash);
+    uint64_t buckets[2];
+    buckets[0] = bloom_reduce(hash, cf->num_buckets);
+    buckets[1] = alt_bucket(cf, buckets[0], fp);
+
+    for (int which = 0; which < 2; which++)
+    {
+        uint64_t v = load_bucket(cf, buckets[which]);
+        for (int slot = 0; slot < CUCKOO_SLOTS; slot++)
+        {
+            if (get_slot(v, slot) == fp)
+            {
+                store_bucket(cf, buckets[which], set_slot(v, slot, 0));
+                cf->count--;
+
+                // A slot just opened up: give the victim a home again
+                if (cf->victim != 0)
+                {
+                    unsigned victim = cf->victim;
+                    uint64_t victim_bucket = cf->victim_bucket;
+                    if (try_place(cf, victim_bucket, victim) == 0 ||
+                        try_place(cf, alt_bucket(cf, victim_bucket, victim), victim) == 0)
+                        cf->victim = 0; // still counted, now in the table
+                }
+                return 0;
+            }
+        }
+    }
+
+    if (cf->victim == fp && (cf->victim_bucket == buckets[0] || cf->victim_bucket == buckets[1]))
+    {
+        cf->victim = 0;
+        cf->count--;
+        return 0;
+    }
+    return -1;
+}
+
+int cuckoo_search(const cuckoo_filter_t *cf, const void *key, size_t len)
+{
+    uint64_t hash = bloom_hash64(key, len, cf->seed);
+    unsigned fp = fingerprint_of(hash);
+    uint64_t first = bloom_reduce(hash, cf->num_buckets);
+    uint64_t second = alt_bucket(cf, first, fp);
+
+    if (bucket_contains(load_bucket(cf, first), fp) || bucket_contains(load_bucket(cf, second), fp))
+        return 1;
+    return cf->victim == fp && (cf->victim_bucket == first || cf->victim_bucket == second);
+}
+
+size_t cuckoo_memory(const cuckoo_filter_t *cf)
+{
+    return sizeof(*cf) + cf->num_buckets * CUCKOO_BUCKET_BYTES + TABLE_PADDING;
+}
@@ -0,0 +1,55 @@
+// cuckoo-filter.h
+// -----------------------------------------------------------------------------
+// Cuckoo filter (Fan et al., 2014): stores a 12-bit fingerprint of every key in
+// one of two 4-slot buckets, so keys can be removed and a lookup reads at most
+// two buckets (two cache lines).
+//
+// Buckets are packed as 48 bits (4 x 12) back to back: ~12.8 bits per key at
+// the 94% load the table is sized for, with a false-positive rate of about
+// 2 * 4 / 2^12 = 0.2%.
+//
+// The alternate bucket is  j = (H(fp) - i) mod m,  an involution that works for
+// any bucket count m, so the table need not be a power of two.
+//
+// Build: gcc -O2 your-program.c cuckoo-filter.c -lm
+// -----------------------------------------------------------------------------
+
+#ifndef CUCKOO_FILTER_H
+#define CUCKOO_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CUCKOO_SLOTS 4           // Fingerprints per bucket
+#define CUCKOO_FINGERPRINT_BITS 12
+#define CUCKOO_BUCKET_BYTES 6    // CUCKOO_SLOTS * CUCKOO_FINGERPRINT_BITS / 8
+#define CUCKOO_LOAD_FACTOR 0.94  // Table sized so capacity keys fill it this much
+#define CUCKOO_MAX_KICKS 500     // Evictions before an insert gives up
+
+typedef struct
+{
+    uint8_t *table;       // num_buckets * CUCKOO_BUCKET_BYTES (+ padding for 8-byte loads)
+    uint64_t num_buckets;
+    uint64_t count;       // Fingerprints stored, victim included
+    uint64_t seed;
+    uint64_t rng;         // Picks which slot to evict
+    uint16_t victim;      // Fingerprint displaced by a failed insert (0 = none)
+    uint64_t victim_bucket;
+} cuckoo_filter_t;
+
+cuckoo_filter_t *cuckoo_create(uint64_t capacity);
+void cuckoo_destroy(cuckoo_filter_t *cf);
+
+// Returns 0, or -1 when the table is full (the key is still findable, held in
+// the victim slot, but no further inserts succeed until something is removed).
+int cuckoo_insert(cuckoo_filter_t *cf, const void *key, size_t len);
+
+// Returns 0, or -1 if no matching fingerprint was found. Only remove keys that
+// were inserted: removing a false positive deletes another key's fingerprint.
+int cuckoo_remove(cuckoo_filter_t *cf, const void *key, size_t len);
+
+int cuckoo_search(const cuckoo_filter_t *cf, const void *key, size_t len); // 1 = possibly present
+
+size_t cuckoo_memory(const cuckoo_filter_t *cf);
+
+#endif // CUCKOO_FILTER_H
@@ -0,0 +1,118 @@
+/*
+ * Membership filter comparison
+ *
+ * Builds every engine in membership.h from the same N keys and reports:
+ *   bits/key       memory held / N
+ *   build ns/key   membership_build() time / N
+ *   hit / miss     lookup cost for inserted keys and for N held-out keys
+ *   fp rate        fraction of held-out keys reported present
+ *
+ * Build: gcc -O2 -march=native membership-bench.c membership.c bloom.c counting-bloom.c \
+ *            cuckoo-filter.c binary-fuse-filter.c -o membership-bench -lm
+ * Usage: ./membership-bench <num_keys> [bloom_fp_rate]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "membership.h"
+
+#define KEY_SLOT 24 // Bytes reserved per generated key
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Fill keys[] with "<prefix><i>" strings stored in storage
+static void make_keys(bloom_key_t *keys, char *storage, size_t count, const char *prefix)
+{
+    for (size_t iterator = 0; iterator < count; iterator++)
+    {
+        char *slot = storage + iterator * KEY_SLOT;
+        keys[iterator].data = slot;
+        keys[iterator].len = (size_t)snprintf(slot, KEY_SLOT, "%s%zu", prefix, iterator);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2 && argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <num_keys> [bloom_fp_rate]\n", argv[0]);
+        return 1;
+    }
+
+    size_t num_keys = strtoull(argv[1], NULL, 10);
+    double fp_rate = argc == 3 ? atof(argv[2]) : 0.01;
+    if (num_keys == 0 || fp_rate <= 0.0 || fp_rate >= 1.0)
+    {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+
+    char *present_storage = malloc(num_keys * KEY_SLOT);
+    char *absent_storage = malloc(num_keys * KEY_SLOT);
+    bloom_key_t *present = malloc(num_keys * sizeof(bloom_key_t));
+    bloom_key_t *absent = malloc(num_keys * sizeof(bloom_key_t));
+    if (present_storage == NULL || absent_storage == NULL || present == NULL || absent == NULL)
+    {
+        perror("malloc");
+        return 1;
+    }
+    make_keys(present, present_storage, num_keys, "key-");
+    make_keys(absent, absent_storage, num_keys, "absent-");
+
+    printf("%zu keys, Bloom engines at fp_rate = %g\n", num_keys, fp_rate);
+    printf("%-16s %9s %13s %11s %12s %10s\n", "engine", "bits/key", "build ns/key", "hit ns/op", "miss ns/op", "fp rate");
+
+    for (int engine = 0; engine < MEMBERSHIP_ENGINE_COUNT; engine++)
+    {
+        double start = now_seconds();
+        membership_t *set = membership_build((membership_engine_t)engine, present, num_keys, fp_rate);
+        double build = now_seconds() - start;
+        if (set == NULL)
+        {
+            printf("%-16s build failed\n", membership_engine_name((membership_engine_t)engine));
+            continue;
+        }
+
+        size_t hits = 0;
+        start = now_seconds();
+        for (size_t iterator = 0; iterator < num_keys; iterator++)
+        {
+            hits += (size_t)membership_search(set, present[iterator].data, present[iterator].len);
+        }
+        double hit_time = now_seconds() - start;
+
+        size_t false_positives = 0;
+        start = now_seconds();
+        for (size_t iterator = 0; iterator < num_keys; iterator++)
+        {
+            false_positives += (size_t)membership_search(set, absent[iterator].data, absent[iterator].len);
+        }
+        double miss_time = now_seconds() - start;
+
+        if (hits != num_keys)
+            fprintf(stderr, "%s: %zu false negatives!\n", membership_engine_name((membership_engine_t)engine),
+                    num_keys - hits);
+
+        printf("%-16s %9.2f %13.1f %11.1f %12.1f %10.5f\n",
+               membership_engine_name((membership_engine_t)engine),
+               (double)membership_memory(set) * 8.0 / (double)num_keys,
+               build / (double)num_keys * 1e9,
+               hit_time / (double)num_keys * 1e9,
+               miss_time / (double)num_keys * 1e9,
+               (double)false_positives / (double)num_keys);
+
+        membership_destroy(set);
+    }
+
+    free(present);
+    free(absent);
+    free(present_storage);
+    free(absent_storage);
+    return 0;
+}
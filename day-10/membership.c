@@ -0,0 +1,227 @@
+// membership.c
+// -----------------------------------------------------------------------------
+// Engine dispatch for the common membership interface (see membership.h).
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <errno.h>
+#include "membership.h"
+#include "counting-bloom.h"
+#include "cuckoo-filter.h"
+#include "binary-fuse-filter.h"
+
+const char *membership_engine_name(membership_engine_t engine)
+{
+    switch (engine)
+    {
+    case MEMBERSHIP_BLOOM:
+        return "bloom";
+    case MEMBERSHIP_BLOOM_BLOCKED:
+        return "bloom-blocked";
+    case MEMBERSHIP_COUNTING_BLOOM:
+        return "counting-bloom";
+    case MEMBERSHIP_CUCKOO:
+        return "cuckoo";
+    case MEMBERSHIP_BINARY_FUSE:
+        return "binary-fuse";
+    default:
+        return "unknown";
+    }
+}
+
+membership_t *membership_create(membership_engine_t engine, uint64_t expected_items, double fp_rate)
+{
+    membership_t *set = malloc(sizeof(*set));
+    if (set == NULL)
+        return NULL;
+    set->engine = engine;
+
+    switch (engine)
+    {
+    case MEMBERSHIP_BLOOM:
+        set->impl = bloom_create(expected_items, fp_rate, BLOOM_STANDARD);
+        break;
+    case MEMBERSHIP_BLOOM_BLOCKED:
+        set->impl = bloom_create(expected_items, fp_rate, BLOOM_BLOCKED);
+        break;
+    case MEMBERSHIP_COUNTING_BLOOM:
+        set->impl = counting_bloom_create(expected_items, fp_rate);
+        break;
+    case MEMBERSHIP_CUCKOO:
+        set->impl = cuckoo_create(expected_items);
+        break;
+    case MEMBERSHIP_BINARY_FUSE:
+        errno = ENOTSUP; // Static: use membership_build()
+        set->impl = NULL;
+        break;
+    default:
+        errno = EINVAL;
+        set->impl = NULL;
+    }
+
+    if (set->impl == NULL)
+    {
+        free(set);
+        return NULL;
+    }
+    return set;
+}
+
+membership_t *membership_build(membership_engine_t engine, const bloom_key_t *keys, size_t count, double fp_rate)
+{
+    if (engine == MEMBERSHIP_BINARY_FUSE)
+    {
+        membership_t *set = malloc(sizeof(*set));
+        if (set == NULL)
+            return NULL;
+        set->engine = engine;
+        set->impl = binary_fuse_build(keys, count);
+        if (set->impl == NULL)
+        {
+            free(set);
+            return NULL;
+        }
+        return set;
+    }
+
+    membership_t *set = membership_create(engine, count ? count : 1, fp_rate);
+    if (set == NULL)
+        return NULL;
+
+    if (engine == MEMBERSHIP_BLOOM || engine == MEMBERSHIP_BLOOM_BLOCKED)
+    {
+        bloom_insert_batch(set->impl, keys, count); // prefetching bulk path
+        return set;
+    }
+
+    for (size_t iterator = 0; iterator < count; iterator++)
+    {
+        if (membership_insert(set, keys[iterator].data, keys[iterator].len) < 0)
+        {
+            membership_destroy(set);
+            return NULL;
+        }
+    }
+    return set;
+}
+
+void membership_destroy(membership_t *set)
+{
+    if (set == NULL)
+        return;
+
+    switch (set->engine)
+    {
+    case MEMBERSHIP_BLOOM:
+    case MEMBERSHIP_BLOOM_BLOCKED:
+        bloom_destroy(set->impl);
+        break;
+    case MEMBERSHIP_COUNTING_BLOOM:
+        counting_bloom_destroy(set->impl);
+        break;
+    case MEMBERSHIP_CUCKOO:
+        cuckoo_destroy(set->impl);
+        break;
+    case MEMBERSHIP_BINARY_FUSE:
+        binary_fuse_destroy(set->impl);
+        break;
+    default:
+        break;
+    }
+    free(set);
+}
+
+int membership_insert(membership_t *set, const void *key, size_t len)
+{
+    switch (set->engine)
+    {
+    case MEMBERSHIP_BLOOM:
+    case MEMBERSHIP_BLOOM_BLOCKED:
+        bloom_insert(set->impl, key, len);
+        return 0;
+    case MEMBERSHIP_COUNTING_BLOOM:
+        counting_bloom_insert(set->impl, key, len);
+        return 0;
+    case MEMBERSHIP_CUCKOO:
+        if (cuckoo_insert(set->impl, key, len) < 0)
+        {
+            errno = ENOSPC;
+            return -1;
+        }
+        return 0;
+    default:
+        errno = ENOTSUP;
+        return -1;
+    }
+}
+
+int membership_remove(membership_t *set, const void *key, size_t len)
+{
+    int result;
+
+    switch (set->engine)
+    {
+    case MEMBERSHIP_COUNTING_BLOOM:
+        result = counting_bloom_remove(set->impl, key, len);
+        break;
+    case MEMBERSHIP_CUCKOO:
+        result = cuckoo_remove(set->impl, key, len);
+        break;
+    default:
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    if (result < 0)
+        errno = ENOENT;
+    return result;
+}
+
+int membership_search(const membership_t *set, const void *key, size_t len)
+{
+    switch (set->engine)
+    {
+    case MEMBERSHIP_BLOOM:
+    case MEMBERSHIP_BLOOM_BLOCKED:
+        return bloom_search(set->impl, key, len);
+    case MEMBERSHIP_COUNTING_BLOOM:
+        return counting_bloom_search(set->impl, key, len);
+    case MEMBERSHIP_CUCKOO:
+        return cuckoo_search(set->impl, key, len);
+    case MEMBERSHIP_BINARY_FUSE:
+        return binary_fuse_search(set->impl, key, len);
+    default:
+        return 0;
+    }
+}
+
+size_t membership_memory(const membership_t *set)
+{
+    size_t total = sizeof(*set);
+
+    switch (set->engine)
+    {
+    case MEMBERSHIP_BLOOM:
+    case MEMBERSHIP_BLOOM_BLOCKED:
+    {
+        const bloom_filter_t *bf = set->impl;
+        total += sizeof(*bf) + bf->num_words * sizeof(uint64_t);
+        break;
+    }
+    case MEMBERSHIP_COUNTING_BLOOM:
+    {
+        const counting_bloom_t *cbf = set->impl;
+        total += sizeof(*cbf) + cbf->num_words * sizeof(uint64_t);
+        break;
+    }
+    case MEMBERSHIP_CUCKOO:
+        total += cuckoo_memory(set->impl);
+        break;
+    case MEMBERSHIP_BINARY_FUSE:
+        total += binary_fuse_memory(set->impl);
+        break;
+    default:
+        break;
+    }
+    return total;
+}
@@ -0,0 +1,63 @@
+// membership.h
+// -----------------------------------------------------------------------------
+// One insert/search interface over every membership filter in day-10, so the
+// engine can be chosen per workload:
+//
+//   engine                        deletes  built from   bits/key       lookup
+//   MEMBERSHIP_BLOOM              no       inserts      9.6 @ 1%       k probes
+//   MEMBERSHIP_BLOOM_BLOCKED      no       inserts      9.6 @ ~1.2%    1 cache line
+//   MEMBERSHIP_COUNTING_BLOOM     yes      inserts      4x Bloom       k probes
+//   MEMBERSHIP_CUCKOO             yes      inserts      ~12.8 @ 0.2%   2 buckets
+//   MEMBERSHIP_BINARY_FUSE        no       whole set    ~9 @ 0.39%     3 probes
+//
+// Build: gcc -O2 your-program.c membership.c bloom.c counting-bloom.c
+//            cuckoo-filter.c binary-fuse-filter.c -lm
+// -----------------------------------------------------------------------------
+
+#ifndef MEMBERSHIP_H
+#define MEMBERSHIP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bloom.h"
+
+typedef enum
+{
+    MEMBERSHIP_BLOOM,
+    MEMBERSHIP_BLOOM_BLOCKED,
+    MEMBERSHIP_COUNTING_BLOOM,
+    MEMBERSHIP_CUCKOO,
+    MEMBERSHIP_BINARY_FUSE,
+    MEMBERSHIP_ENGINE_COUNT
+} membership_engine_t;
+
+typedef struct
+{
+    membership_engine_t engine;
+    void *impl; // bloom_filter_t, counting_bloom_t, cuckoo_filter_t or binary_fuse_t
+} membership_t;
+
+const char *membership_engine_name(membership_engine_t engine);
+
+// Empty filter for expected_items keys. fp_rate applies to the Bloom engines;
+// the cuckoo filter's rate is fixed by its fingerprint size. Static engines
+// (MEMBERSHIP_BINARY_FUSE) cannot be created empty: NULL with errno = ENOTSUP.
+membership_t *membership_create(membership_engine_t engine, uint64_t expected_items, double fp_rate);
+
+// Filter holding exactly the given keys. Works for every engine; the only way
+// to construct a static one.
+membership_t *membership_build(membership_engine_t engine, const bloom_key_t *keys, size_t count, double fp_rate);
+
+void membership_destroy(membership_t *set);
+
+// 0 on success; -1 with errno = ENOTSUP (static engine) or ENOSPC (cuckoo full)
+int membership_insert(membership_t *set, const void *key, size_t len);
+
+// 0 on success; -1 with errno = ENOTSUP (no deletes) or ENOENT (not present)
+int membership_remove(membership_t *set, const void *key, size_t len);
+
+int membership_search(const membership_t *set, const void *key, size_t len); // 1 = possibly present
+
+size_t membership_memory(const membership_t *set); // Bytes held
+
+#endif // MEMBERSHIP_H
@@ -0,0 +1,51 @@
+// Build: gcc -O2 scalable-bloom-filter.c scalable-bloom.c bloom.c -o scalable-bloom-filter -lm
+#include <stdio.h>
+#include <string.h>
+#include "scalable-bloom.h"
+
+// Sized for only 1000 keys, then fed 1000x more: stages are added as needed
+#define INITIAL_CAPACITY 1000
+#define FP_RATE 0.01
+#define PROBES 100000
+
+int main()
+{
+    scalable_bloom_t *sbf = scalable_bloom_create(INITIAL_CAPACITY, FP_RATE, BLOOM_STANDARD);
+    if (sbf == NULL)
+    {
+        perror("scalable_bloom_create failed");
+        return 1;
+    }
+
+    printf("%10s %7s %12s %12s %12s\n", "keys", "stages", "memory(KB)", "estimated", "measured");
+
+    char word[32];
+    uint64_t inserted = 0;
+    for (uint64_t target = INITIAL_CAPACITY; target <= INITIAL_CAPACITY * 1000; target *= 10)
+    {
+        for (; inserted < target; inserted++)
+        {
+            int n = snprintf(word, sizeof(word), "word%lu", (unsigned long)inserted);
+            if (scalable_bloom_insert(sbf, word, (size_t)n) < 0)
+            {
+                perror("scalable_bloom_insert failed");
+                return 1;
+            }
+        }
+
+        // held-out keys that were never inserted
+        int false_positives = 0;
+        for (int iterator = 0; iterator < PROBES; iterator++)
+        {
+            int n = snprintf(word, sizeof(word), "absent%d", iterator);
+            false_positives += scalable_bloom_search(sbf, word, (size_t)n);
+        }
+
+        printf("%10lu %7zu %12.1f %12.5f %12.5f\n", (unsigned long)scalable_bloom_count(sbf),
+               sbf->num_stages, scalable_bloom_memory(sbf) / 1024.0,
+               scalable_bloom_fp_estimate(sbf), (double)false_positives / PROBES);
+    }
+
+    scalable_bloom_destroy(sbf);
+    return 0;
+}
@@ -0,0 +1,162 @@
+// scalable-bloom.c
+// -----------------------------------------------------------------------------
+// Scalable Bloom filter built from a growing chain of bloom.h filters
+// (see scalable-bloom.h).
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <math.h>
+#include "scalable-bloom.h"
+
+/*------------------------------------------------
+  Append a stage sized for the next capacity and
+  error rate in the geometric sequence
+-------------------------------------------------*/
+static int add_stage(scalable_bloom_t *sbf)
+{
+    if (sbf->num_stages == sbf->max_stages)
+    {
+        size_t max_stages = sbf->max_stages ? sbf->max_stages * 2 : 8;
+        bloom_filter_t **stages = realloc(sbf->stages, max_stages * sizeof(*stages));
+        if (stages == NULL)
+            return -1;
+        sbf->stages = stages;
+
+        uint64_t *capacities = realloc(sbf->capacities, max_stages * sizeof(*capacities));
+        if (capacities == NULL)
+            return -1;
+        sbf->capacities = capacities;
+
+        uint64_t *counts = realloc(sbf->counts, max_stages * sizeof(*counts));
+        if (counts == NULL)
+            return -1;
+        sbf->counts = counts;
+
+        double *fp_rates = realloc(sbf->fp_rates, max_stages * sizeof(*fp_rates));
+        if (fp_rates == NULL)
+            return -1;
+        sbf->fp_rates = fp_rates;
+
+        sbf->max_stages = max_stages;
+    }
+
+    size_t stage = sbf->num_stages;
+    uint64_t capacity = sbf->initial_capacity;
+    double fp_rate = sbf->fp_rate * (1.0 - SCALABLE_BLOOM_TIGHTENING);
+    if (stage > 0)
+    {
+        capacity = sbf->capacities[stage - 1] * SCALABLE_BLOOM_GROWTH;
+        fp_rate = sbf->fp_rates[stage - 1] * SCALABLE_BLOOM_TIGHTENING;
+    }
+
+    bloom_filter_t *bf = bloom_create(capacity, fp_rate, sbf->flags);
+    if (bf == NULL)
+        return -1;
+
+    sbf->stages[stage] = bf;
+    sbf->capacities[stage] = capacity;
+    sbf->counts[stage] = 0;
+    sbf->fp_rates[stage] = fp_rate;
+    sbf->num_stages++;
+    return 0;
+}
+
+scalable_bloom_t *scalable_bloom_create(uint64_t initial_capacity, double fp_rate, unsigned flags)
+{
+    if (initial_capacity == 0 || fp_rate <= 0.0 || fp_rate >= 1.0)
+        return NULL;
+
+    scalable_bloom_t *sbf = calloc(1, sizeof(*sbf));
+    if (sbf == NULL)
+        return NULL;
+    sbf->initial_capacity = initial_capacity;
+    sbf->fp_rate = fp_rate;
+    sbf->flags = flags;
+
+    if (add_stage(sbf) < 0)
+    {
+        scalable_bloom_destroy(sbf);
+        return NULL;
+    }
+    return sbf;
+}
+
+void scalable_bloom_destroy(scalable_bloom_t *sbf)
+{
+    if (sbf == NULL)
+        return;
+    for (size_t iterator = 0; iterator < sbf->num_stages; iterator++)
+    {
+        bloom_destroy(sbf->stages[iterator]);
+    }
+    free(sbf->stages);
+    free(sbf->capacities);
+    free(sbf->counts);
+    free(sbf->fp_rates);
+    free(sbf);
+}
+
+int scalable_bloom_insert(scalable_bloom_t *sbf, const void *key, size_t len)
+{
+    if (scalable_bloom_search(sbf, key, len))
+        return 0;
+
+    size_t last = sbf->num_stages - 1;
+    if (sbf->counts[last] >= sbf->capacities[last])
+    {
+        if (add_stage(sbf) < 0)
+            return -1;
+        last++;
+    }
+
+    bloom_insert(sbf->stages[last], key, len);
+    sbf->counts[last]++;
+    return 0;
+}
+
+int scalable_bloom_search(const scalable_bloom_t *sbf, const void *key, size_t len)
+{
+    // Newest stage first: it is the largest and holds the most recent keys
+    for (size_t iterator = sbf->num_stages; iterator-- > 0;)
+    {
+        if (bloom_search(sbf->stages[iterator], key, len))
+            return 1;
+    }
+    return 0;
+}
+
+uint64_t scalable_bloom_count(const scalable_bloom_t *sbf)
+{
+    uint64_t total = 0;
+    for (size_t iterator = 0; iterator < sbf->num_stages; iterator++)
+    {
+        total += sbf->counts[iterator];
+    }
+    return total;
+}
+
+size_t scalable_bloom_memory(const scalable_bloom_t *sbf)
+{
+    size_t total = sizeof(*sbf) +
+                   sbf->max_stages * (sizeof(bloom_filter_t *) + 2 * sizeof(uint64_t) + sizeof(double));
+    for (size_t iterator = 0; iterator < sbf->num_stages; iterator++)
+    {
+        total += sizeof(bloom_filter_t) + sbf->stages[iterator]->num_words * sizeof(uint64_t);
+    }
+    return total;
+}
+
+double scalable_bloom_fp_estimate(const scalable_bloom_t *sbf)
+{
+    // Per stage: (1 - e^(-k n / m))^k for its actual n; a lookup is a false
+    // positive if any stage reports one
+    double all_negative = 1.0;
+    for (size_t iterator = 0; iterator < sbf->num_stages; iterator++)
+    {
+        const bloom_filter_t *bf = sbf->stages[iterator];
+        double k = (double)bf->num_hashes;
+        double fill = 1.0 - exp(-k * (double)sbf->counts[iterator] / (double)bf->num_bits);
+        all_negative *= 1.0 - pow(fill, k);
+    }
+    return 1.0 - all_negative;
+}
@@ -0,0 +1,50 @@
+// scalable-bloom.h
+// -----------------------------------------------------------------------------
+// Scalable Bloom filter (Almeida et al., 2007): a chain of bloom.h filters that
+// grows as keys are inserted, so the final cardinality need not be known.
+//
+// Stage i has capacity  n0 * GROWTH^i  and error rate  p0 * TIGHTENING^i.
+// With p0 = P * (1 - TIGHTENING) the compound false-positive rate
+//     1 - prod(1 - p_i)  <=  sum(p_i)  <  P
+// stays below the target P however many stages are added.
+//
+// Build: gcc -O2 your-program.c scalable-bloom.c bloom.c -lm
+// -----------------------------------------------------------------------------
+
+#ifndef SCALABLE_BLOOM_H
+#define SCALABLE_BLOOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bloom.h"
+
+#define SCALABLE_BLOOM_GROWTH 2      // Capacity multiplier per stage
+#define SCALABLE_BLOOM_TIGHTENING 0.5 // Error-rate multiplier per stage
+
+typedef struct
+{
+    bloom_filter_t **stages;  // stages[num_stages - 1] takes new inserts
+    uint64_t *capacities;     // Keys each stage was sized for
+    uint64_t *counts;         // Keys inserted into each stage
+    double *fp_rates;         // Error rate each stage was sized for
+    size_t num_stages;
+    size_t max_stages;        // Allocated length of the arrays above
+    uint64_t initial_capacity;
+    double fp_rate;           // Overall target P
+    unsigned flags;           // BLOOM_* flags passed to every stage
+} scalable_bloom_t;
+
+// initial_capacity: keys the first stage holds before a second one is added
+scalable_bloom_t *scalable_bloom_create(uint64_t initial_capacity, double fp_rate, unsigned flags);
+void scalable_bloom_destroy(scalable_bloom_t *sbf);
+
+// Keys already reported present are not inserted again, so duplicates do not
+// use up capacity. Returns 0, or -1 if a new stage could not be allocated.
+int scalable_bloom_insert(scalable_bloom_t *sbf, const void *key, size_t len);
+int scalable_bloom_search(const scalable_bloom_t *sbf, const void *key, size_t len); // 1 = possibly present
+
+uint64_t scalable_bloom_count(const scalable_bloom_t *sbf);     // Keys inserted
+size_t scalable_bloom_memory(const scalable_bloom_t *sbf);      // Bytes held, bit arrays included
+double scalable_bloom_fp_estimate(const scalable_bloom_t *sbf); // From each stage's actual fill
+
+#endif // SCALABLE_BLOOM_H
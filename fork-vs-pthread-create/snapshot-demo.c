@@ -0,0 +1,207 @@
+/*
+ * Background snapshot while serving (snapshot.h)
+ *
+ * Builds a table of table_mb of 64-byte records, measures how many record
+ * updates per second the parent sustains, then takes a fork-based snapshot
+ * and keeps updating random records for as long as the child dumps. Prints
+ * the fork pause, the memory duplicated by copy-on-write, the dump
+ * throughput and the parent's update rate during the dump.
+ *
+ * Finally the file is read back and checked: its header generation must be
+ * the one at fork() time and every record must be internally consistent,
+ * even though the parent kept writing throughout.
+ *
+ * --huge-pages backs the table with transparent huge pages: fork() copies
+ * 512x fewer page-table entries, so the pause shrinks with table size.
+ *
+ * Build: gcc -O2 snapshot-demo.c snapshot.c -o snapshot-demo
+ * Usage: ./snapshot-demo <table_mb> [snapshot_path] [--huge-pages]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "snapshot.h"
+
+#define TABLE_MAGIC 0x50414e53u // "SNAP"
+#define RECORD_WORDS 6
+#define BATCH 4096 // Updates between snapshot_poll() calls
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t generation; // Updates applied so far
+    uint64_t num_records;
+    uint64_t pad[5];
+} table_header_t;
+
+typedef struct
+{
+    uint64_t key;
+    uint64_t version;
+    uint64_t payload[RECORD_WORDS]; // key * (i + 1) + version
+} record_t;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: record choice
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static void set_record(record_t *record, uint64_t key, uint64_t version)
+{
+    record->key = key;
+    record->version = version;
+    for (int iterator = 0; iterator < RECORD_WORDS; ++iterator)
+    {
+        record->payload[iterator] = key * (uint64_t)(iterator + 1) + version;
+    }
+}
+
+static int record_is_consistent(const record_t *record, uint64_t key)
+{
+    record_t expected;
+    set_record(&expected, key, record->version);
+    return memcmp(&expected, record, sizeof(expected)) == 0;
+}
+
+/* The "serving" work: BATCH random record updates */
+static void update_batch(table_header_t *header, record_t *records, uint64_t *rng)
+{
+    for (int iterator = 0; iterator < BATCH; ++iterator)
+    {
+        uint64_t key = next_random(rng) % header->num_records;
+        set_record(&records[key], key, records[key].version + 1);
+        header->generation++;
+    }
+}
+
+/* Read the snapshot back; 0 if it matches the table at fork() time */
+static int verify_snapshot(const char *path, uint64_t expected_generation, uint64_t num_records)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    table_header_t header;
+    int ok = fread(&header, sizeof(header), 1, file) == 1 && header.magic == TABLE_MAGIC &&
+             header.generation == expected_generation && header.num_records == num_records;
+
+    static record_t chunk[16384];
+    uint64_t key = 0;
+    while (ok && key < num_records)
+    {
+        size_t want = num_records - key < 16384 ? (size_t)(num_records - key) : 16384;
+        ok = fread(chunk, sizeof(record_t), want, file) == want;
+        for (size_t iterator = 0; ok && iterator < want; ++iterator, ++key)
+        {
+            ok = record_is_consistent(&chunk[iterator], key);
+        }
+    }
+    fclose(file);
+    return ok ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = "table.snap";
+    size_t table_mb = 0;
+    int huge_pages = 0;
+    for (int iterator = 1; iterator < argc; ++iterator)
+    {
+        if (strcmp(argv[iterator], "--huge-pages") == 0)
+            huge_pages = 1;
+        else if (table_mb == 0)
+            table_mb = strtoull(argv[iterator], NULL, 10);
+        else
+            path = argv[iterator];
+    }
+    if (table_mb == 0)
+    {
+        fprintf(stderr, "Usage: %s <table_mb> [snapshot_path] [--huge-pages]\n", argv[0]);
+        return 1;
+    }
+
+    /* Build the table */
+    size_t size = table_mb << 20;
+    table_header_t *header = snapshot_alloc(size, huge_pages);
+    if (header == NULL)
+    {
+        perror("snapshot_alloc");
+        return 1;
+    }
+    record_t *records = (record_t *)(header + 1);
+    header->magic = TABLE_MAGIC;
+    header->generation = 0;
+    header->num_records = (size - sizeof(*header)) / sizeof(record_t);
+    for (uint64_t key = 0; key < header->num_records; ++key)
+    {
+        set_record(&records[key], key, 0);
+    }
+    size_t used = sizeof(*header) + header->num_records * sizeof(record_t);
+
+    /* Update rate without a snapshot */
+    uint64_t rng = 0x9e3779b97f4a7c15ULL;
+    uint64_t updates = 0;
+    double start = now_seconds();
+    while (now_seconds() - start < 1.0)
+    {
+        update_batch(header, records, &rng);
+        updates += BATCH;
+    }
+    double idle_rate = (double)updates / (now_seconds() - start);
+
+    /* Snapshot while updating */
+    snapshot_t snap;
+    uint64_t generation_at_fork = header->generation;
+    if (snapshot_start(&snap, path, header, used) < 0)
+    {
+        perror("snapshot_start");
+        return 1;
+    }
+    updates = 0;
+    start = now_seconds();
+    int status;
+    while ((status = snapshot_poll(&snap, 0)) == 0)
+    {
+        update_batch(header, records, &rng);
+        updates += BATCH;
+    }
+    double busy_rate = (double)updates / (now_seconds() - start);
+    if (status < 0)
+    {
+        perror("snapshot");
+        return 1;
+    }
+
+    printf("table:            %zu MB, %lu records, %s pages\n", table_mb, (unsigned long)header->num_records,
+           huge_pages ? "huge" : "small");
+    printf("fork pause:       %.2f ms\n", snap.result.fork_pause_ms);
+    printf("dump:             %.1f MB in %.2f s, %.0f MB/s\n", (double)snap.result.bytes_written / 1048576.0,
+           snap.result.write_seconds, snap.result.mb_per_second);
+    printf("COW duplicated:   %.1f MB (child Private_Dirty), %ld parent minor faults\n",
+           (double)snap.result.cow_bytes / 1048576.0, snap.result.parent_minor_faults);
+    printf("updates/s:        %.0f idle, %.0f during the dump\n", idle_rate, busy_rate);
+
+    int verified = verify_snapshot(path, generation_at_fork, header->num_records);
+    printf("snapshot check:   %s (generation %lu at fork, %lu now)\n", verified == 0 ? "consistent" : "FAILED",
+           (unsigned long)generation_at_fork, (unsigned long)header->generation);
+
+    snapshot_free(header, size);
+    return verified == 0 ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+// snapshot.c
+// -----------------------------------------------------------------------------
+// Fork-based snapshot of an in-memory region (see snapshot.h).
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "snapshot.h"
+
+#define SNAPSHOT_ALIGN (2UL << 20) // Huge page size on x86-64 and arm64 (4K base pages)
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static long minor_faults(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}
+
+// Private_Dirty of the calling process in bytes, 0 if unavailable
+static uint64_t private_dirty_bytes(void)
+{
+    FILE *file = fopen("/proc/self/smaps_rollup", "r");
+    if (file == NULL)
+        return 0;
+    char line[256];
+    unsigned long long kb = 0;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (sscanf(line, "Private_Dirty: %llu", &kb) == 1)
+            break;
+    }
+    fclose(file);
+    return (uint64_t)kb * 1024;
+}
+
+void *snapshot_alloc(size_t size, int huge_pages)
+{
+    /* Over-map, then trim to a 2 MB aligned range so huge pages can back it */
+    size_t length = (size + SNAPSHOT_ALIGN - 1) & ~(SNAPSHOT_ALIGN - 1);
+    char *mapping = mmap(NULL, length + SNAPSHOT_ALIGN, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+        return NULL;
+    char *region = (char *)(((uintptr_t)mapping + SNAPSHOT_ALIGN - 1) & ~(SNAPSHOT_ALIGN - 1));
+    if (region > mapping)
+        munmap(mapping, (size_t)(region - mapping));
+    size_t tail = (size_t)(mapping + length + SNAPSHOT_ALIGN - (region + length));
+    if (tail > 0)
+        munmap(region + length, tail);
+
+    // Failure only means small pages (kernel without THP); not fatal
+    madvise(region, length, huge_pages ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+    return region;
+}
+
+void snapshot_free(void *region, size_t size)
+{
+    if (region != NULL)
+        munmap(region, (size + SNAPSHOT_ALIGN - 1) & ~(SNAPSHOT_ALIGN - 1));
+}
+
+/*
+ * Child side: write the frozen region to "<path>.tmp", fsync, rename, then
+ * fsync the directory so the rename itself survives a crash.
+ * Returns 0 or an errno value.
+ */
+static int dump_region(const char *path, const char *region, size_t size, snapshot_progress_t *progress)
+{
+    char tmp_path[PATH_MAX];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path))
+        return ENAMETOOLONG;
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+        return errno;
+
+    double start = now_seconds();
+    size_t offset = 0;
+    while (offset < size)
+    {
+        size_t length = size - offset < SNAPSHOT_CHUNK ? size - offset : SNAPSHOT_CHUNK;
+        ssize_t w = write(fd, region + offset, length);
+        if (w < 0)
+        {
+            if (errno == EINTR)
+                continue; // Interrupted -> retry
+            int error = errno;
+            close(fd);
+            unlink(tmp_path);
+            return error;
+        }
+        offset += (size_t)w;
+        __atomic_store_n(&progress->bytes_written, (uint64_t)offset, __ATOMIC_RELAXED);
+    }
+    if (fsync(fd) < 0 || close(fd) < 0 || rename(tmp_path, path) < 0)
+    {
+        int error = errno;
+        unlink(tmp_path);
+        return error;
+    }
+
+    // Persist the rename by syncing the containing directory
+    char dir_path[PATH_MAX];
+    const char *slash = strrchr(path, '/');
+    if (slash == NULL)
+        strcpy(dir_path, ".");
+    else if (slash == path)
+        strcpy(dir_path, "/");
+    else
+        snprintf(dir_path, sizeof(dir_path), "%.*s", (int)(slash - path), path);
+
+    int dir_fd = open(dir_path, O_RDONLY);
+    if (dir_fd >= 0)
+    {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    progress->write_seconds = now_seconds() - start;
+    return 0;
+}
+
+int snapshot_start(snapshot_t *snap, const char *path, const void *region, size_t size)
+{
+    memset(snap, 0, sizeof(*snap));
+    snap->progress = mmap(NULL, sizeof(snapshot_progress_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                          -1, 0);
+    if (snap->progress == MAP_FAILED)
+    {
+        snap->progress = NULL;
+        return -1;
+    }
+    memset(snap->progress, 0, sizeof(snapshot_progress_t));
+
+    /* Flush stdio first: the child must not repeat buffered output */
+    fflush(NULL);
+    snap->start_minor_faults = minor_faults();
+    double start = now_seconds();
+    pid_t pid = fork();
+    snap->result.fork_pause_ms = (now_seconds() - start) * 1e3;
+    if (pid < 0)
+    {
+        int error = errno;
+        munmap(snap->progress, sizeof(snapshot_progress_t));
+        snap->progress = NULL;
+        errno = error;
+        return -1;
+    }
+    if (pid == 0)
+    {
+        // Child: every page the parent writes from now on becomes private here
+        snapshot_progress_t *progress = snap->progress;
+        uint64_t baseline = private_dirty_bytes();
+        progress->error = dump_region(path, region, size, progress);
+        uint64_t dirty = private_dirty_bytes();
+        progress->cow_bytes = dirty > baseline ? dirty - baseline : 0;
+        _exit(progress->error == 0 ? EXIT_SUCCESS : EXIT_FAILURE); // No atexit handlers of the parent
+    }
+
+    snap->pid = pid;
+    return 0;
+}
+
+int snapshot_poll(snapshot_t *snap, int wait)
+{
+    if (snap->pid <= 0)
+    {
+        errno = ECHILD;
+        return -1;
+    }
+
+    int status;
+    pid_t reaped;
+    while ((reaped = waitpid(snap->pid, &status, wait ? 0 : WNOHANG)) < 0 && errno == EINTR)
+        ;
+    if (reaped == 0)
+        return 0; // Still dumping
+    snap->pid = 0;
+
+    snapshot_progress_t progress = *snap->progress;
+    munmap(snap->progress, sizeof(snapshot_progress_t));
+    snap->progress = NULL;
+    if (reaped < 0)
+        return -1;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        errno = progress.error != 0 ? progress.error : EIO; // EIO: killed by a signal
+        return -1;
+    }
+
+    snap->result.write_seconds = progress.write_seconds;
+    snap->result.bytes_written = progress.bytes_written;
+    snap->result.mb_per_second =
+        progress.write_seconds > 0.0 ? (double)progress.bytes_written / 1048576.0 / progress.write_seconds : 0.0;
+    snap->result.cow_bytes = progress.cow_bytes;
+    snap->result.parent_minor_faults = minor_faults() - snap->start_minor_faults;
+    return 1;
+}
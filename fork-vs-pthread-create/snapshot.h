@@ -0,0 +1,83 @@
+// snapshot.h
+// -----------------------------------------------------------------------------
+// Fork-based point-in-time snapshot of an in-memory region (Redis BGSAVE
+// style).
+//
+// snapshot_start() forks. The child sees the region exactly as it was at
+// fork() time - copy-on-write keeps its pages frozen while the parent goes on
+// mutating - and streams it to "<path>.tmp", fsyncs and renames it to path
+// and fsyncs the directory, so path is always either the previous or the new
+// complete snapshot, even across a crash. The
+// parent only pays for fork() itself (copying the page tables of its whole
+// address space) and for the page copies its own writes trigger.
+//
+//     void *table = snapshot_alloc(size, 1);          // huge pages: fewer PTEs
+//     snapshot_t snap;
+//     snapshot_start(&snap, "table.snap", table, size);
+//     while (snapshot_poll(&snap, 0) == 0)
+//         serve_and_mutate(table);                   // keeps running meanwhile
+//     printf("%.2f ms pause, %.1f MB copied\n", snap.result.fork_pause_ms,
+//            snap.result.cow_bytes / 1048576.0);
+//
+// Reported per snapshot: the fork pause, the pages duplicated by
+// copy-on-write during the dump (the child's Private_Dirty from
+// /proc/self/smaps_rollup, as Redis does, plus the parent's minor faults) and
+// the write throughput.
+//
+// One snapshot at a time per snapshot_t; the caller must not exit or reap
+// all children (waitpid(-1)) while one runs.
+//
+// Build: gcc -O2 your-program.c snapshot.c
+// -----------------------------------------------------------------------------
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/types.h>
+
+#define SNAPSHOT_CHUNK (1 << 20) // Bytes per write() in the child
+
+typedef struct
+{
+    double fork_pause_ms;   // Parent blocked in fork()
+    double write_seconds;   // Child: first write() to directory fsync
+    double mb_per_second;   // Dump throughput
+    uint64_t bytes_written;
+    uint64_t cow_bytes;     // Child pages made private by copy-on-write
+    long parent_minor_faults; // Parent faults while the child ran (COW copies, new pages)
+} snapshot_result_t;
+
+// Shared between parent and child (one MAP_SHARED page)
+typedef struct
+{
+    uint64_t bytes_written; // Progress, updated per chunk
+    double write_seconds;
+    uint64_t cow_bytes;
+    int error;              // errno of the failed step, 0 = ok
+} snapshot_progress_t;
+
+typedef struct
+{
+    pid_t pid;                     // Child, 0 when no snapshot runs
+    snapshot_progress_t *progress;
+    long start_minor_faults;
+    snapshot_result_t result;      // Valid once snapshot_poll() returned 1
+} snapshot_t;
+
+// Anonymous memory for a snapshotted region, 2 MB aligned. With huge_pages,
+// MADV_HUGEPAGE asks for transparent huge pages: 512x fewer page-table
+// entries to copy in fork(). NULL on error.
+void *snapshot_alloc(size_t size, int huge_pages);
+void snapshot_free(void *region, size_t size);
+
+// Fork and start dumping region[0 .. size) to path. 0 or -1 (errno set).
+int snapshot_start(snapshot_t *snap, const char *path, const void *region, size_t size);
+
+// 1 = finished (snap->result filled), 0 = still running (only with
+// wait == 0), -1 = failed (errno set to the child's error).
+int snapshot_poll(snapshot_t *snap, int wait);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,363 @@
+/*
+ * Process/thread spawn-cost benchmark
+ *
+ * fork-demo.c and pthread-demo.c show one fork() and one pthread_create();
+ * this measures what they cost. For every parent RSS size and method it
+ * creates `iterations` children one after another and records:
+ *
+ *   create  - time until the call returns in the parent: how long the parent
+ *             is stalled (for fork: copying page tables of the whole RSS)
+ *   total   - create plus waiting for the child to finish (waitpid/join)
+ *
+ * and reports spawns per second with p50/p99 of both.
+ *
+ * Methods (process children run `helper`, default /bin/true, like a server
+ * spawning a helper program would):
+ *
+ *   fork         fork(), child calls _exit(0) - page-table copy + teardown only
+ *   fork-exec    fork(), child execs helper
+ *   vfork-exec   vfork(), child execs helper; parent suspended, no copy
+ *   posix_spawn  posix_spawn(helper) (glibc uses clone(CLONE_VM|CLONE_VFORK))
+ *   clone-vm     clone(CLONE_VM) on a private stack, child execs helper
+ *   pthread      pthread_create() of an empty thread, then pthread_join()
+ *
+ * Before each RSS step the parent maps and writes that many MB of anonymous
+ * memory, so every page is resident and has a page-table entry to copy.
+ * The memory is MADV_NOHUGEPAGE by default, so the numbers do not depend on
+ * the system's THP setting; --thp asks for MADV_HUGEPAGE instead (one PMD
+ * entry per 2 MB, far less for fork to copy).
+ *
+ * Build: gcc -O2 -pthread spawn-bench.c -o spawn-bench
+ * Usage: ./spawn-bench [--rss-mb 1,64,1024,16384] [--iterations n]
+ *                      [--methods fork,vfork-exec,...] [--helper path] [--thp]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#define MAX_STEPS 32
+#define CLONE_STACK_SIZE (64 * 1024)
+
+extern char **environ;
+
+typedef enum
+{
+    METHOD_FORK,
+    METHOD_FORK_EXEC,
+    METHOD_VFORK_EXEC,
+    METHOD_POSIX_SPAWN,
+    METHOD_CLONE_VM,
+    METHOD_PTHREAD,
+    METHOD_COUNT
+} method_t;
+
+static const char *const method_names[METHOD_COUNT] = {"fork",        "fork-exec", "vfork-exec",
+                                                       "posix_spawn", "clone-vm",  "pthread"};
+
+static const char *helper = "/bin/true";
+static char *helper_argv[2];
+static char *clone_stack;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// p-th percentile (0..100) of sorted samples
+static double percentile(const double *sorted, int n, double p)
+{
+    int index = (int)(p / 100.0 * (double)(n - 1) + 0.5);
+    return sorted[index];
+}
+
+static void *empty_thread(void *arg)
+{
+    return arg;
+}
+
+static int exec_helper(void *arg)
+{
+    (void)arg;
+    execve(helper, helper_argv, environ);
+    _exit(127); // exec failed
+}
+
+/*------------------------------------------------
+  Create one child with the given method
+  - Returns its pid (0 for a thread, stored in
+    *thread), or -1 on error
+-------------------------------------------------*/
+static pid_t spawn_child(method_t method, pthread_t *thread)
+{
+    pid_t pid = -1;
+    switch (method)
+    {
+    case METHOD_FORK:
+        pid = fork();
+        if (pid == 0)
+            _exit(0);
+        return pid;
+    case METHOD_FORK_EXEC:
+        pid = fork();
+        if (pid == 0)
+            exec_helper(NULL);
+        return pid;
+    case METHOD_VFORK_EXEC:
+        pid = vfork();
+        if (pid == 0)
+            exec_helper(NULL); // Only exec or _exit are allowed after vfork()
+        return pid;
+    case METHOD_POSIX_SPAWN:
+    {
+        int error = posix_spawn(&pid, helper, NULL, NULL, helper_argv, environ);
+        if (error != 0)
+        {
+            errno = error;
+            return -1;
+        }
+        return pid;
+    }
+    case METHOD_CLONE_VM:
+        return clone(exec_helper, clone_stack + CLONE_STACK_SIZE, CLONE_VM | SIGCHLD, NULL);
+    case METHOD_PTHREAD:
+    {
+        int error = pthread_create(thread, NULL, empty_thread, NULL);
+        if (error != 0)
+        {
+            errno = error;
+            return -1;
+        }
+        return 0;
+    }
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+}
+
+/*------------------------------------------------
+  Wait for a child; 0 if it exited with status 0
+-------------------------------------------------*/
+static int reap_child(method_t method, pid_t pid, pthread_t thread)
+{
+    if (method == METHOD_PTHREAD)
+        return pthread_join(thread, NULL) == 0 ? 0 : -1;
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+            return -1;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+/*------------------------------------------------
+  Run one method `iterations` times and print
+  one result row
+-------------------------------------------------*/
+static int run_method(method_t method, size_t rss_mb, int iterations, double *create, double *total)
+{
+    double start = now_seconds();
+    for (int iterator = 0; iterator < iterations; ++iterator)
+    {
+        pthread_t thread;
+        double t0 = now_seconds();
+        pid_t pid = spawn_child(method, &thread);
+        double t1 = now_seconds();
+        if (pid < 0)
+        {
+            perror(method_names[method]);
+            return -1;
+        }
+        if (reap_child(method, pid, thread) < 0)
+        {
+            fprintf(stderr, "%s: child failed (helper %s)\n", method_names[method], helper);
+            return -1;
+        }
+        double t2 = now_seconds();
+        create[iterator] = (t1 - t0) * 1e6;
+        total[iterator] = (t2 - t0) * 1e6;
+    }
+    double elapsed = now_seconds() - start;
+
+    qsort(create, (size_t)iterations, sizeof(double), compare_doubles);
+    qsort(total, (size_t)iterations, sizeof(double), compare_doubles);
+    printf("%8zu %-12s %12.0f %12.1f %12.1f %12.1f %12.1f\n", rss_mb, method_names[method],
+           (double)iterations / elapsed, percentile(create, iterations, 50.0), percentile(create, iterations, 99.0),
+           percentile(total, iterations, 50.0), percentile(total, iterations, 99.0));
+    fflush(stdout);
+    return 0;
+}
+
+/*------------------------------------------------
+  Map and write rss_mb of anonymous memory so it
+  is resident, in small or transparent huge pages;
+  NULL on failure
+-------------------------------------------------*/
+static char *make_resident(size_t rss_mb, int huge_pages)
+{
+    size_t bytes = rss_mb << 20;
+    char *memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return NULL;
+    // Before the first touch, or the pages are already allocated. Failure
+    // only means a kernel without THP: small pages either way
+    madvise(memory, bytes, huge_pages ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+    long page_size = sysconf(_SC_PAGESIZE);
+    for (size_t offset = 0; offset < bytes; offset += (size_t)page_size)
+    {
+        memory[offset] = 1;
+    }
+    return memory;
+}
+
+// Parse "a,b,c" into sizes; returns the count or -1
+static int parse_sizes(const char *text, size_t *values, int max_values)
+{
+    int count = 0;
+    char *copy = strdup(text);
+    for (char *token = strtok(copy, ","); token != NULL; token = strtok(NULL, ","))
+    {
+        char *end;
+        unsigned long long value = strtoull(token, &end, 10);
+        if (count == max_values || *end != '\0' || value == 0)
+        {
+            count = -1;
+            break;
+        }
+        values[count++] = (size_t)value;
+    }
+    free(copy);
+    return count;
+}
+
+// Parse "fork,pthread" into a method mask; returns 0 if a name is unknown
+static unsigned parse_methods(const char *text)
+{
+    unsigned mask = 0;
+    char *copy = strdup(text);
+    for (char *token = strtok(copy, ","); token != NULL; token = strtok(NULL, ","))
+    {
+        int found = 0;
+        for (int method = 0; method < METHOD_COUNT; ++method)
+        {
+            if (strcmp(token, method_names[method]) == 0)
+            {
+                mask |= 1u << method;
+                found = 1;
+            }
+        }
+        if (!found)
+        {
+            mask = 0;
+            break;
+        }
+    }
+    free(copy);
+    return mask;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [--rss-mb 1,64,1024,16384] [--iterations n] [--methods a,b] [--helper path] [--thp]\n",
+            prog);
+    fprintf(stderr, "  methods: fork, fork-exec, vfork-exec, posix_spawn, clone-vm, pthread (default: all)\n");
+}
+
+int main(int argc, char **argv)
+{
+    size_t rss_sizes[MAX_STEPS] = {1, 64, 1024};
+    int num_sizes = 3;
+    int iterations = 200;
+    unsigned methods = (1u << METHOD_COUNT) - 1;
+    int huge_pages = 0;
+
+    for (int iterator = 1; iterator < argc; ++iterator)
+    {
+        const char *option = argv[iterator];
+        if (strcmp(option, "--thp") == 0)
+        {
+            huge_pages = 1;
+            continue;
+        }
+        const char *value = iterator + 1 < argc ? argv[++iterator] : NULL;
+        if (value == NULL)
+            num_sizes = -1;
+        else if (strcmp(option, "--rss-mb") == 0)
+            num_sizes = parse_sizes(value, rss_sizes, MAX_STEPS);
+        else if (strcmp(option, "--iterations") == 0)
+            iterations = atoi(value);
+        else if (strcmp(option, "--methods") == 0)
+            methods = parse_methods(value);
+        else if (strcmp(option, "--helper") == 0)
+            helper = value;
+        else
+            num_sizes = -1;
+
+        if (num_sizes < 1 || iterations < 1 || methods == 0)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    helper_argv[0] = (char *)helper;
+    helper_argv[1] = NULL;
+    clone_stack = malloc(CLONE_STACK_SIZE);
+    double *create = malloc((size_t)iterations * sizeof(double));
+    double *total = malloc((size_t)iterations * sizeof(double));
+    if (clone_stack == NULL || create == NULL || total == NULL)
+    {
+        perror("malloc");
+        return 1;
+    }
+
+    printf("%d spawns per step, helper %s, %s, times in us\n", iterations, helper,
+           huge_pages ? "MADV_HUGEPAGE (--thp)" : "MADV_NOHUGEPAGE");
+    printf("%8s %-12s %12s %12s %12s %12s %12s\n", "rss MB", "method", "spawns/s", "create p50", "create p99",
+           "total p50", "total p99");
+
+    for (int step = 0; step < num_sizes; ++step)
+    {
+        char *memory = make_resident(rss_sizes[step], huge_pages);
+        if (memory == NULL)
+        {
+            fprintf(stderr, "cannot make %zu MB resident: %s\n", rss_sizes[step], strerror(errno));
+            continue;
+        }
+        for (int method = 0; method < METHOD_COUNT; ++method)
+        {
+            if (!(methods & (1u << method)))
+                continue;
+            if (run_method((method_t)method, rss_sizes[step], iterations, create, total) < 0)
+                return 1;
+        }
+        munmap(memory, rss_sizes[step] << 20);
+    }
+
+    free(create);
+    free(total);
+    free(clone_stack);
+    return 0;
+}
@@ -0,0 +1,112 @@
+// bravo-rwlock.c
+// -----------------------------------------------------------------------------
+// Reader-biased wrapper around pthread_rwlock_t (see bravo-rwlock.h).
+// -----------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <time.h>
+#include "bravo-rwlock.h"
+#include "cpu-relax.h"
+
+#define SPINS_BEFORE_YIELD 1024
+
+// Shared by all BRAVO locks in the process; 32 KB
+static bravo_rwlock_t *visible_readers[BRAVO_TABLE_SIZE] __attribute__((aligned(64)));
+
+static __thread uintptr_t thread_tag; // Address of a TLS variable: unique per thread
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static unsigned slot_of(const bravo_rwlock_t *lock)
+{
+    uint64_t h = (uint64_t)(uintptr_t)&thread_tag ^ ((uint64_t)(uintptr_t)lock << 7);
+    h *= 0x9e3779b97f4a7c15ULL;
+    return (unsigned)(h >> 52) & (BRAVO_TABLE_SIZE - 1);
+}
+
+int bravo_rwlock_init(bravo_rwlock_t *lock)
+{
+    lock->read_bias = 1;
+    lock->inhibit_until = 0;
+    return pthread_rwlock_init(&lock->underlying, NULL) == 0 ? 0 : -1;
+}
+
+void bravo_rwlock_destroy(bravo_rwlock_t *lock)
+{
+    pthread_rwlock_destroy(&lock->underlying);
+}
+
+unsigned bravo_rwlock_rdlock(bravo_rwlock_t *lock)
+{
+    if (__atomic_load_n(&lock->read_bias, __ATOMIC_RELAXED))
+    {
+        unsigned slot = slot_of(lock);
+        bravo_rwlock_t *expected = NULL;
+        // Seq-cst CAS then seq-cst load: pairs with the writer's store of
+        // read_bias = 0 followed by its table scan
+        if (__atomic_compare_exchange_n(&visible_readers[slot], &expected, lock, 0, __ATOMIC_SEQ_CST,
+                                        __ATOMIC_RELAXED))
+        {
+            if (__atomic_load_n(&lock->read_bias, __ATOMIC_SEQ_CST))
+                return slot + 1;
+            __atomic_store_n(&visible_readers[slot], NULL, __ATOMIC_RELEASE); // Raced a revocation
+        }
+    }
+
+    /* Slow path; re-enable the bias once the inhibit window has passed */
+    pthread_rwlock_rdlock(&lock->underlying);
+    if (!__atomic_load_n(&lock->read_bias, __ATOMIC_RELAXED) &&
+        now_ns() >= __atomic_load_n(&lock->inhibit_until, __ATOMIC_RELAXED))
+        __atomic_store_n(&lock->read_bias, 1, __ATOMIC_RELAXED); // No writer can be inside: we hold rdlock
+    return 0;
+}
+
+void bravo_rwlock_rdunlock(bravo_rwlock_t *lock, unsigned token)
+{
+    if (token != 0)
+        __atomic_store_n(&visible_readers[token - 1], NULL, __ATOMIC_RELEASE);
+    else
+        pthread_rwlock_unlock(&lock->underlying);
+}
+
+void bravo_rwlock_wrlock(bravo_rwlock_t *lock)
+{
+    pthread_rwlock_wrlock(&lock->underlying);
+    if (!__atomic_load_n(&lock->read_bias, __ATOMIC_RELAXED))
+        return;
+
+    /* Revoke: stop new fast-path readers, wait out the ones already in */
+    __atomic_store_n(&lock->read_bias, 0, __ATOMIC_SEQ_CST);
+    uint64_t start = now_ns();
+    unsigned spins = 0;
+    for (unsigned iterator = 0; iterator < BRAVO_TABLE_SIZE; iterator++)
+    {
+        // Sequentially consistent like the store above: an acquire load may
+        // be ordered before it and miss a reader that then sees the old bias
+        while (__atomic_load_n(&visible_readers[iterator], __ATOMIC_SEQ_CST) == lock)
+        {
+            if (++spins < SPINS_BEFORE_YIELD)
+            {
+                cpu_relax();
+            }
+            else
+            {
+                spins = 0;
+                sched_yield();
+            }
+        }
+    }
+    uint64_t now = now_ns();
+    __atomic_store_n(&lock->inhibit_until, now + (now - start) * BRAVO_INHIBIT_MULTIPLIER, __ATOMIC_RELAXED);
+}
+
+void bravo_rwlock_wrunlock(bravo_rwlock_t *lock)
+{
+    pthread_rwlock_unlock(&lock->underlying);
+}
@@ -0,0 +1,47 @@
+// bravo-rwlock.h
+// -----------------------------------------------------------------------------
+// BRAVO (Biased Locking for Reader-Writer Locks, Dice & Kogan 2019) on top of
+// pthread_rwlock_t.
+//
+// While the lock is read-biased, a reader does not touch the rwlock at all:
+// it publishes itself by CAS-ing the lock's address into a slot of a global
+// "visible readers" table chosen by hashing (thread, lock). Different readers
+// land in different slots, so there is no shared reader count to bounce.
+//
+//   reader fast path:  CAS table[h] NULL -> lock; recheck bias; done
+//   reader slow path:  bias off or slot taken -> pthread_rwlock_rdlock
+//   writer:            wrlock, then revoke the bias: clear it and wait until
+//                      no table slot holds this lock
+//
+// Revocation costs a scan of the table, so after a revocation the bias stays
+// off for BRAVO_INHIBIT_MULTIPLIER times as long as the scan took; a slow-path
+// reader turns it back on once that has passed. Write-heavy phases thus run
+// as a plain rwlock and read-mostly phases get the scalable fast path.
+// -----------------------------------------------------------------------------
+
+#ifndef BRAVO_RWLOCK_H
+#define BRAVO_RWLOCK_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#define BRAVO_TABLE_SIZE 4096     // Global visible-readers slots (power of two)
+#define BRAVO_INHIBIT_MULTIPLIER 9 // Bias stays off for N x revocation time
+
+typedef struct
+{
+    pthread_rwlock_t underlying;
+    uint32_t read_bias;     // Nonzero: readers may use the table
+    uint64_t inhibit_until; // ns (CLOCK_MONOTONIC) before which bias stays off
+} bravo_rwlock_t;
+
+int bravo_rwlock_init(bravo_rwlock_t *lock); // 0 or -1
+void bravo_rwlock_destroy(bravo_rwlock_t *lock);
+
+// rdlock returns a token for rdunlock: table slot + 1, or 0 for the slow path
+unsigned bravo_rwlock_rdlock(bravo_rwlock_t *lock);
+void bravo_rwlock_rdunlock(bravo_rwlock_t *lock, unsigned token);
+void bravo_rwlock_wrlock(bravo_rwlock_t *lock);
+void bravo_rwlock_wrunlock(bravo_rwlock_t *lock);
+
+#endif // BRAVO_RWLOCK_H
@@ -0,0 +1,287 @@
+// cpu-topology.c
+// -----------------------------------------------------------------------------
+// /sys topology parsing and placement plans (see cpu-topology.h).
+// -----------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "cpu-topology.h"
+
+const char *placement_name(placement_t placement)
+{
+    switch (placement)
+    {
+    case PLACEMENT_NONE:
+        return "none";
+    case PLACEMENT_COMPACT:
+        return "compact";
+    case PLACEMENT_SCATTER:
+        return "scatter";
+    case PLACEMENT_PHYSICAL:
+        return "physical";
+    case PLACEMENT_NUMA_NODE:
+        return "numa-node";
+    default:
+        return "unknown";
+    }
+}
+
+int placement_parse(const char *name)
+{
+    for (int placement = 0; placement < PLACEMENT_COUNT; placement++)
+    {
+        if (strcmp(name, placement_name((placement_t)placement)) == 0)
+            return placement;
+    }
+    return -1;
+}
+
+static int read_sys_int(int cpu, const char *file, int fallback)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, file);
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+        return fallback;
+    int value;
+    if (fscanf(f, "%d", &value) != 1 || value < 0)
+        value = fallback;
+    fclose(f);
+    return value;
+}
+
+// The cpuN directory holds a "nodeM" link on NUMA kernels
+static int read_node(int cpu)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *dir = opendir(path);
+    if (dir == NULL)
+        return 0;
+    int node = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        char *end;
+        if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] != '\0')
+        {
+            long value = strtol(entry->d_name + 4, &end, 10);
+            if (*end == '\0')
+            {
+                node = (int)value;
+                break;
+            }
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+static int count_distinct(const cpu_topology_t *topology, int key_of(const cpu_info_t *))
+{
+    int count = 0;
+    for (int i = 0; i < topology->num_cpus; i++)
+    {
+        int seen = 0;
+        for (int j = 0; j < i && !seen; j++)
+        {
+            seen = key_of(&topology->cpus[j]) == key_of(&topology->cpus[i]);
+        }
+        count += !seen;
+    }
+    return count;
+}
+
+static int core_key(const cpu_info_t *c)
+{
+    return c->package * 65536 + c->core;
+}
+
+static int package_key(const cpu_info_t *c)
+{
+    return c->package;
+}
+
+static int node_key(const cpu_info_t *c)
+{
+    return c->node;
+}
+
+int cpu_topology_load(cpu_topology_t *topology)
+{
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return -1;
+
+    topology->num_cpus = 0;
+    topology->cpus = malloc((size_t)CPU_COUNT(&allowed) * sizeof(cpu_info_t));
+    if (topology->cpus == NULL)
+        return -1;
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (!CPU_ISSET(cpu, &allowed))
+            continue;
+        cpu_info_t *info = &topology->cpus[topology->num_cpus++];
+        info->cpu = cpu;
+        info->package = read_sys_int(cpu, "physical_package_id", 0);
+        info->core = read_sys_int(cpu, "core_id", cpu);
+        info->node = read_node(cpu);
+
+        /* SMT index: how many earlier CPUs share this physical core */
+        info->smt_index = 0;
+        for (int other = 0; other < topology->num_cpus - 1; other++)
+        {
+            if (core_key(&topology->cpus[other]) == core_key(info))
+                info->smt_index++;
+        }
+    }
+
+    topology->num_cores = count_distinct(topology, core_key);
+    topology->num_packages = count_distinct(topology, package_key);
+    topology->num_nodes = count_distinct(topology, node_key);
+    return 0;
+}
+
+void cpu_topology_free(cpu_topology_t *topology)
+{
+    free(topology->cpus);
+    topology->cpus = NULL;
+    topology->num_cpus = 0;
+}
+
+void cpu_topology_print(const cpu_topology_t *topology, FILE *out)
+{
+    fprintf(out, "topology: %d CPUs, %d physical cores, %d packages, %d NUMA nodes\n", topology->num_cpus,
+            topology->num_cores, topology->num_packages, topology->num_nodes);
+    fprintf(out, "%6s %6s %8s %6s %6s\n", "cpu", "node", "package", "core", "smt");
+    for (int iterator = 0; iterator < topology->num_cpus; iterator++)
+    {
+        const cpu_info_t *c = &topology->cpus[iterator];
+        fprintf(out, "%6d %6d %8d %6d %6d\n", c->cpu, c->node, c->package, c->core, c->smt_index);
+    }
+}
+
+/*------------------------------------------------
+  Sort orders for the policies
+-------------------------------------------------*/
+
+// node, package, core, SMT sibling
+static int compare_compact(const void *a, const void *b)
+{
+    const cpu_info_t *x = a, *y = b;
+    if (x->node != y->node)
+        return x->node - y->node;
+    if (x->package != y->package)
+        return x->package - y->package;
+    if (x->core != y->core)
+        return x->core - y->core;
+    return x->smt_index - y->smt_index;
+}
+
+typedef struct
+{
+    int cpu;
+    int package;
+    int smt_index;
+    int core_rank; // Position of the core within its package
+} scatter_slot_t;
+
+// SMT sibling, then core rank, then package: consecutive threads alternate packages
+static int compare_scatter(const void *a, const void *b)
+{
+    const scatter_slot_t *x = a, *y = b;
+    if (x->smt_index != y->smt_index)
+        return x->smt_index - y->smt_index;
+    if (x->core_rank != y->core_rank)
+        return x->core_rank - y->core_rank;
+    return x->package - y->package;
+}
+
+int cpu_topology_plan(const cpu_topology_t *topology, placement_t placement, int num_threads, int *cpus)
+{
+    if (placement == PLACEMENT_NONE || topology->num_cpus == 0)
+    {
+        for (int iterator = 0; iterator < num_threads; iterator++)
+        {
+            cpus[iterator] = -1;
+        }
+        return 0;
+    }
+
+    // The node we run on; if sched_getcpu() fails (or names a CPU outside
+    // the affinity mask), the node of the first allowed CPU, so numa-node
+    // always has at least one CPU
+    int home_node = topology->cpus[0].node;
+    int current = sched_getcpu();
+    for (int iterator = 0; iterator < topology->num_cpus; iterator++)
+    {
+        if (topology->cpus[iterator].cpu == current)
+            home_node = topology->cpus[iterator].node;
+    }
+
+    cpu_info_t order[topology->num_cpus];
+    int count = 0;
+    for (int iterator = 0; iterator < topology->num_cpus; iterator++)
+    {
+        const cpu_info_t *c = &topology->cpus[iterator];
+        if (placement == PLACEMENT_PHYSICAL && c->smt_index != 0)
+            continue;
+        if (placement == PLACEMENT_NUMA_NODE && c->node != home_node)
+            continue;
+        order[count++] = *c;
+    }
+    if (count == 0)
+    {
+        for (int iterator = 0; iterator < num_threads; iterator++)
+        {
+            cpus[iterator] = -1; // Nothing to pin to: leave threads unpinned
+        }
+        return 0;
+    }
+    qsort(order, (size_t)count, sizeof(cpu_info_t), compare_compact);
+
+    if (placement == PLACEMENT_SCATTER)
+    {
+        scatter_slot_t slots[count];
+        int rank = 0;
+        for (int iterator = 0; iterator < count; iterator++)
+        {
+            if (iterator > 0 && order[iterator].package != order[iterator - 1].package)
+                rank = 0;
+            else if (iterator > 0 && order[iterator].core != order[iterator - 1].core)
+                rank++;
+            slots[iterator].cpu = order[iterator].cpu;
+            slots[iterator].package = order[iterator].package;
+            slots[iterator].smt_index = order[iterator].smt_index;
+            slots[iterator].core_rank = rank;
+        }
+        qsort(slots, (size_t)count, sizeof(scatter_slot_t), compare_scatter);
+        for (int iterator = 0; iterator < num_threads; iterator++)
+        {
+            cpus[iterator] = slots[iterator % count].cpu;
+        }
+        return count;
+    }
+
+    for (int iterator = 0; iterator < num_threads; iterator++)
+    {
+        cpus[iterator] = order[iterator % count].cpu;
+    }
+    return count;
+}
+
+int cpu_pin_self(int cpu)
+{
+    if (cpu < 0)
+        return 0;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
@@ -0,0 +1,71 @@
+// cpu-topology.h
+// -----------------------------------------------------------------------------
+// CPU topology from /sys and thread placement policies for benchmarks.
+//
+// For every CPU the process may run on (sched_getaffinity), reads
+//   /sys/devices/system/cpu/cpuN/topology/physical_package_id
+//   /sys/devices/system/cpu/cpuN/topology/core_id
+//   /sys/devices/system/cpu/cpuN/nodeM         (NUMA node link)
+// and numbers the SMT siblings of each physical core 0, 1, ...
+//
+// Placement policies (thread i -> cpus[i], wrapping if there are more
+// threads than CPUs in the policy):
+//   compact    fill one core's SMT siblings, then the next core, then the
+//              next package: threads share caches, no cross-socket traffic
+//   scatter    round-robin over packages, first SMT thread of each core
+//              first: maximum aggregate cache and memory bandwidth
+//   physical   one thread per physical core (SMT siblings left idle)
+//   numa-node  only CPUs of the NUMA node the caller runs on, compact order
+//
+// Build: gcc -O2 your-program.c cpu-topology.c
+// -----------------------------------------------------------------------------
+
+#ifndef CPU_TOPOLOGY_H
+#define CPU_TOPOLOGY_H
+
+#include <stdio.h>
+
+typedef struct
+{
+    int cpu;        // Logical CPU number
+    int package;    // physical_package_id (socket)
+    int core;       // core_id, unique within a package
+    int node;       // NUMA node, 0 if the kernel exposes none
+    int smt_index;  // 0 for the first hardware thread of a core, 1 for its sibling, ...
+} cpu_info_t;
+
+typedef struct
+{
+    cpu_info_t *cpus; // Sorted by CPU number
+    int num_cpus;
+    int num_cores;
+    int num_packages;
+    int num_nodes;
+} cpu_topology_t;
+
+typedef enum
+{
+    PLACEMENT_NONE, // Leave it to the scheduler
+    PLACEMENT_COMPACT,
+    PLACEMENT_SCATTER,
+    PLACEMENT_PHYSICAL,
+    PLACEMENT_NUMA_NODE,
+    PLACEMENT_COUNT
+} placement_t;
+
+const char *placement_name(placement_t placement);
+int placement_parse(const char *name); // placement_t, or -1 if unknown
+
+int cpu_topology_load(cpu_topology_t *topology); // 0 or -1 (errno set)
+void cpu_topology_free(cpu_topology_t *topology);
+void cpu_topology_print(const cpu_topology_t *topology, FILE *out);
+
+// Fill cpus[0 .. num_threads) with the CPU each thread should be pinned to
+// (-1 for PLACEMENT_NONE, or when the policy offers none). Returns how many
+// distinct CPUs the policy offers.
+int cpu_topology_plan(const cpu_topology_t *topology, placement_t placement, int num_threads, int *cpus);
+
+// Pin the calling thread to one CPU. Returns 0 or an errno value.
+int cpu_pin_self(int cpu);
+
+#endif // CPU_TOPOLOGY_H
@@ -0,0 +1,131 @@
+// epoch.c
+// -----------------------------------------------------------------------------
+// Epoch advance and deferred reclamation (see epoch.h).
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "epoch.h"
+
+int epoch_domain_init(epoch_domain_t *domain, int max_threads)
+{
+    memset(domain, 0, sizeof(*domain));
+    void *threads;
+    if (max_threads <= 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    if (posix_memalign(&threads, 64, (size_t)max_threads * sizeof(epoch_thread_t)) != 0)
+        return -1;
+    memset(threads, 0, (size_t)max_threads * sizeof(epoch_thread_t));
+    domain->threads = threads;
+    domain->max_threads = max_threads;
+    domain->global_epoch = 2; // Retirement epoch - 2 never underflows
+    return 0;
+}
+
+static void account(epoch_domain_t *domain, int64_t bytes, int64_t nodes)
+{
+    uint64_t now_bytes = __atomic_add_fetch(&domain->deferred_bytes, (uint64_t)bytes, __ATOMIC_RELAXED);
+    uint64_t now_nodes = __atomic_add_fetch(&domain->deferred_nodes, (uint64_t)nodes, __ATOMIC_RELAXED);
+    if (bytes <= 0)
+        return;
+
+    uint64_t peak = __atomic_load_n(&domain->peak_deferred_bytes, __ATOMIC_RELAXED);
+    while (now_bytes > peak && !__atomic_compare_exchange_n(&domain->peak_deferred_bytes, &peak, now_bytes, 1,
+                                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+    peak = __atomic_load_n(&domain->peak_deferred_nodes, __ATOMIC_RELAXED);
+    while (now_nodes > peak && !__atomic_compare_exchange_n(&domain->peak_deferred_nodes, &peak, now_nodes, 1,
+                                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+// Free entries of one limbo list retired at or before `safe`
+static void reclaim_list(epoch_domain_t *domain, epoch_entry_t **list, uint64_t safe)
+{
+    /* Newest first: skip the entries that must still wait, cut the rest */
+    epoch_entry_t **link = list;
+    while (*link != NULL && (*link)->epoch > safe)
+    {
+        link = &(*link)->next;
+    }
+    epoch_entry_t *entry = *link;
+    *link = NULL;
+
+    int64_t bytes = 0, nodes = 0;
+    while (entry != NULL)
+    {
+        epoch_entry_t *next = entry->next;
+        bytes += (int64_t)entry->bytes;
+        nodes++;
+        entry->reclaim(entry);
+        entry = next;
+    }
+    if (nodes > 0)
+        account(domain, -bytes, -nodes);
+}
+
+void epoch_domain_destroy(epoch_domain_t *domain)
+{
+    for (int iterator = 0; iterator < domain->num_threads; iterator++)
+    {
+        reclaim_list(domain, &domain->threads[iterator].limbo, UINT64_MAX);
+    }
+    free(domain->threads);
+    domain->threads = NULL;
+}
+
+epoch_thread_t *epoch_register(epoch_domain_t *domain)
+{
+    int index = __atomic_fetch_add(&domain->num_threads, 1, __ATOMIC_RELAXED);
+    if (index >= domain->max_threads)
+        return NULL;
+    return &domain->threads[index];
+}
+
+void epoch_retire(epoch_domain_t *domain, epoch_thread_t *self, epoch_entry_t *entry)
+{
+    // Full fence: the caller's unlink (often only a release store) must be
+    // visible before we read the epoch, or a reader entering a later epoch
+    // could still load the node (writer-side smp_mb(), as in userspace RCU)
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    entry->epoch = __atomic_load_n(&domain->global_epoch, __ATOMIC_SEQ_CST);
+    entry->next = self->limbo;
+    self->limbo = entry;
+    account(domain, (int64_t)entry->bytes, 1);
+
+    if (++self->retired_since_scan >= EPOCH_SCAN_INTERVAL)
+    {
+        self->retired_since_scan = 0;
+        epoch_poll(domain, self);
+    }
+}
+
+void epoch_poll(epoch_domain_t *domain, epoch_thread_t *self)
+{
+    // Pairs with the fence in epoch_enter(): our unlinks are visible before
+    // the reader slots are scanned
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    uint64_t epoch = __atomic_load_n(&domain->global_epoch, __ATOMIC_SEQ_CST);
+
+    /* Advance only if every active reader has announced the current epoch */
+    int registered = __atomic_load_n(&domain->num_threads, __ATOMIC_ACQUIRE);
+    if (registered > domain->max_threads)
+        registered = domain->max_threads;
+    int all_current = 1;
+    for (int iterator = 0; iterator < registered && all_current; iterator++)
+    {
+        uint64_t state = __atomic_load_n(&domain->threads[iterator].state, __ATOMIC_ACQUIRE);
+        all_current = !(state & 1) || (state >> 1) == epoch;
+    }
+    if (all_current)
+        __atomic_compare_exchange_n(&domain->global_epoch, &epoch, epoch + 1, 0, __ATOMIC_SEQ_CST,
+                                    __ATOMIC_RELAXED);
+
+    /* Entries retired two epochs ago are unreachable for every reader */
+    epoch = __atomic_load_n(&domain->global_epoch, __ATOMIC_SEQ_CST);
+    reclaim_list(domain, &self->limbo, epoch - 2);
+}
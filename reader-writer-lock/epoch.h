@@ -0,0 +1,91 @@
+// epoch.h
+// -----------------------------------------------------------------------------
+// Epoch-based reclamation (userspace-RCU style) for read-mostly structures.
+//
+// Readers take no lock and write no shared line: they announce the current
+// global epoch in their own padded slot, traverse the structure, and clear
+// the slot. Writers publish a new version of a node with a release store,
+// then retire the old node instead of freeing it. A retired node is freed
+// only after the global epoch has advanced twice past its retirement, which
+// requires every reader that was active at the time to have left its
+// read-side section - so no reader can still hold a pointer to it.
+//
+//     epoch_thread_t *self = epoch_register(&domain);      // once per thread
+//
+//     epoch_enter(self);                                    // reader
+//     node = __atomic_load_n(&head, __ATOMIC_ACQUIRE); ...
+//     epoch_exit(self);
+//
+//     __atomic_store_n(&head, new_node, __ATOMIC_RELEASE);  // writer
+//     epoch_retire(&domain, self, &old_node->entry);
+//
+// Retired nodes wait on a per-thread limbo list; every EPOCH_SCAN_INTERVAL
+// retirements the retiring thread tries to advance the epoch and frees what
+// became safe. The domain tracks bytes and nodes waiting, with their peak.
+//
+// Build: gcc -O2 your-program.c epoch.c
+// -----------------------------------------------------------------------------
+
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define EPOCH_SCAN_INTERVAL 64
+
+// Embed in every node that may be retired
+typedef struct epoch_entry
+{
+    struct epoch_entry *next;
+    uint64_t epoch;                           // Global epoch at retirement
+    size_t bytes;                             // For the deferred-memory accounting
+    void (*reclaim)(struct epoch_entry *entry); // Frees the enclosing node
+} epoch_entry_t;
+
+typedef struct
+{
+    uint64_t state;        // (announced epoch << 1) | active
+    epoch_entry_t *limbo;  // Retired by this thread, newest first
+    unsigned retired_since_scan;
+} __attribute__((aligned(64))) epoch_thread_t;
+
+typedef struct
+{
+    uint64_t global_epoch __attribute__((aligned(64)));
+    epoch_thread_t *threads;
+    int max_threads;
+    int num_threads; // Registered so far
+    uint64_t deferred_bytes __attribute__((aligned(64)));
+    uint64_t deferred_nodes;
+    uint64_t peak_deferred_bytes;
+    uint64_t peak_deferred_nodes;
+} epoch_domain_t;
+
+int epoch_domain_init(epoch_domain_t *domain, int max_threads); // 0 or -1 (errno set)
+void epoch_domain_destroy(epoch_domain_t *domain);              // Frees all retired nodes; no readers left
+
+// A slot for the calling thread; NULL when max_threads are registered
+epoch_thread_t *epoch_register(epoch_domain_t *domain);
+
+static inline void epoch_enter(epoch_domain_t *domain, epoch_thread_t *self)
+{
+    uint64_t epoch = __atomic_load_n(&domain->global_epoch, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->state, (epoch << 1) | 1, __ATOMIC_RELAXED);
+    // The announcement must be visible before any protected pointer is read
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void epoch_exit(epoch_thread_t *self)
+{
+    __atomic_store_n(&self->state, 0, __ATOMIC_RELEASE);
+}
+
+// Defer entry->reclaim(entry) until no reader can reach the node. The node
+// must already be unlinked (unreachable for new readers).
+void epoch_retire(epoch_domain_t *domain, epoch_thread_t *self, epoch_entry_t *entry);
+
+// Try to advance the epoch and free this thread's safe limbo entries
+void epoch_poll(epoch_domain_t *domain, epoch_thread_t *self);
+
+#endif // EPOCH_H
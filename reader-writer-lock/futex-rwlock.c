@@ -0,0 +1,106 @@
+// futex-rwlock.c
+// -----------------------------------------------------------------------------
+// Spin-then-park futex reader-writer lock (see futex-rwlock.h).
+// -----------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "futex-rwlock.h"
+#include "cpu-relax.h"
+
+static void futex_wait(uint32_t *addr, uint32_t expected)
+{
+    // Returns at once (EAGAIN) if *addr != expected: no lost wake-ups
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static void futex_wake_all(uint32_t *addr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+// Fold the polls a spin needed into the lock's budget (EMA, 1/8): a success
+// pulls it toward twice what it took, a failure (polls = 0) toward the floor
+static void adapt_budget(futex_rwlock_t *lock, int polls)
+{
+    int32_t budget = __atomic_load_n(&lock->spin_budget, __ATOMIC_RELAXED);
+    int32_t target = polls * 2 < FUTEX_RW_MAX_SPIN ? polls * 2 : FUTEX_RW_MAX_SPIN;
+    budget += (target - budget) / 8;
+    __atomic_store_n(&lock->spin_budget, budget < 10 ? 10 : budget, __ATOMIC_RELAXED);
+}
+
+/*------------------------------------------------
+  Shared acquire/park loop
+  - blocked: state bits that keep us out
+  - delta:   what a successful acquire adds
+-------------------------------------------------*/
+static void acquire(futex_rwlock_t *lock, uint32_t blocked, uint32_t delta)
+{
+    int budget = __atomic_load_n(&lock->spin_budget, __ATOMIC_RELAXED);
+    int polls = 0;
+    for (;;)
+    {
+        uint32_t state = __atomic_load_n(&lock->state, __ATOMIC_RELAXED);
+        if (!(state & blocked))
+        {
+            if (__atomic_compare_exchange_n(&lock->state, &state, state + delta, 0, __ATOMIC_ACQUIRE,
+                                            __ATOMIC_RELAXED))
+            {
+                if (polls > 0 && polls <= budget)
+                    adapt_budget(lock, polls);
+                return;
+            }
+            continue; // Lost a race, state changed: re-evaluate
+        }
+
+        if (polls < budget)
+        {
+            polls++;
+            cpu_relax();
+            continue;
+        }
+
+        /* Spinning did not pay off: spin less next time, announce ourselves and park */
+        if (polls == budget)
+        {
+            adapt_budget(lock, 0);
+            polls++;
+        }
+        if (!(state & FUTEX_RW_WAITERS) &&
+            !__atomic_compare_exchange_n(&lock->state, &state, state | FUTEX_RW_WAITERS, 0, __ATOMIC_RELAXED,
+                                         __ATOMIC_RELAXED))
+            continue;
+        futex_wait(&lock->state, state | FUTEX_RW_WAITERS);
+    }
+}
+
+void futex_rwlock_rdlock(futex_rwlock_t *lock)
+{
+    acquire(lock, FUTEX_RW_WRITER, 1);
+}
+
+void futex_rwlock_rdunlock(futex_rwlock_t *lock)
+{
+    uint32_t state = __atomic_sub_fetch(&lock->state, 1, __ATOMIC_RELEASE);
+    if ((state & FUTEX_RW_READERS) == 0 && (state & FUTEX_RW_WAITERS))
+    {
+        // Last reader out: wake everyone, they re-arm WAITERS if they block again
+        __atomic_fetch_and(&lock->state, ~FUTEX_RW_WAITERS, __ATOMIC_RELAXED);
+        futex_wake_all(&lock->state);
+    }
+}
+
+void futex_rwlock_wrlock(futex_rwlock_t *lock)
+{
+    acquire(lock, FUTEX_RW_WRITER | FUTEX_RW_READERS, FUTEX_RW_WRITER);
+}
+
+void futex_rwlock_wrunlock(futex_rwlock_t *lock)
+{
+    uint32_t state = __atomic_fetch_and(&lock->state, ~(FUTEX_RW_WRITER | FUTEX_RW_WAITERS), __ATOMIC_RELEASE);
+    if (state & FUTEX_RW_WAITERS)
+        futex_wake_all(&lock->state);
+}
@@ -0,0 +1,45 @@
+// futex-rwlock.h
+// -----------------------------------------------------------------------------
+// Reader-writer lock built directly on one 32-bit futex word:
+//
+//   bits 0..29  number of readers holding the lock
+//   bit  30     FUTEX_RW_WRITER   a writer holds the lock
+//   bit  31     FUTEX_RW_WAITERS  someone is (or is about to be) parked
+//
+// Uncontended acquire and release are a single CAS / atomic op with no system
+// call. A blocked thread first spins for up to spin_budget polls, hoping the
+// holder releases soon, and only then parks in futex(FUTEX_WAIT). The budget
+// adapts per lock: it follows a moving average of how many polls successful
+// spinners actually needed, and every spin that runs out pulls it toward the
+// floor, so short critical sections keep spinning and long ones park quickly
+// instead of burning CPU.
+//
+// Readers are preferred (like the glibc pthread_rwlock default): a writer
+// waits until the reader count drains to zero.
+// -----------------------------------------------------------------------------
+
+#ifndef FUTEX_RWLOCK_H
+#define FUTEX_RWLOCK_H
+
+#include <stdint.h>
+
+#define FUTEX_RW_READERS 0x3fffffffu
+#define FUTEX_RW_WRITER 0x40000000u
+#define FUTEX_RW_WAITERS 0x80000000u
+
+#define FUTEX_RW_MAX_SPIN 1000 // Upper bound of the adaptive spin budget
+
+typedef struct
+{
+    uint32_t state;
+    int32_t spin_budget; // Adaptive: polls worth spinning before parking
+} futex_rwlock_t;
+
+#define FUTEX_RWLOCK_INITIALIZER {0, 100}
+
+void futex_rwlock_rdlock(futex_rwlock_t *lock);
+void futex_rwlock_rdunlock(futex_rwlock_t *lock);
+void futex_rwlock_wrlock(futex_rwlock_t *lock);
+void futex_rwlock_wrunlock(futex_rwlock_t *lock);
+
+#endif // FUTEX_RWLOCK_H
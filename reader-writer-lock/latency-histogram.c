@@ -0,0 +1,87 @@
+// latency-histogram.c
+// -----------------------------------------------------------------------------
+// Merging, percentiles and tick calibration (see latency-histogram.h).
+// -----------------------------------------------------------------------------
+
+#include <string.h>
+#include "latency-histogram.h"
+
+static double ns_per_tick = 1.0;
+
+void latency_reset(latency_histogram_t *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+}
+
+void latency_merge(latency_histogram_t *dst, const latency_histogram_t *src)
+{
+    for (unsigned iterator = 0; iterator < LATENCY_BUCKETS; iterator++)
+    {
+        dst->counts[iterator] += src->counts[iterator];
+    }
+    dst->total += src->total;
+    if (src->max > dst->max)
+        dst->max = src->max;
+}
+
+// Largest value that maps to bucket
+static uint64_t bucket_upper(unsigned bucket)
+{
+    if (bucket < LATENCY_SUB_BUCKETS)
+        return bucket;
+    unsigned shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    uint64_t sub = bucket % LATENCY_SUB_BUCKETS;
+    uint64_t lower = (LATENCY_SUB_BUCKETS + sub) << shift;
+    return lower + ((1ULL << shift) - 1);
+}
+
+uint64_t latency_percentile(const latency_histogram_t *hist, double p)
+{
+    if (hist->total == 0)
+        return 0;
+    uint64_t rank = (uint64_t)(p / 100.0 * (double)hist->total + 0.5);
+    if (rank < 1)
+        rank = 1;
+    if (rank > hist->total)
+        rank = hist->total;
+
+    uint64_t seen = 0;
+    for (unsigned iterator = 0; iterator < LATENCY_BUCKETS; iterator++)
+    {
+        seen += hist->counts[iterator];
+        if (seen >= rank)
+        {
+            uint64_t upper = bucket_upper(iterator);
+            return upper < hist->max ? upper : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void latency_calibrate(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t ns_start = monotonic_ns();
+    uint64_t ticks_start = latency_now();
+    struct timespec pause = {0, 20 * 1000 * 1000};
+    nanosleep(&pause, NULL);
+    uint64_t ns = monotonic_ns() - ns_start;
+    uint64_t ticks = latency_now() - ticks_start;
+    if (ticks > 0)
+        ns_per_tick = (double)ns / (double)ticks;
+#else
+    ns_per_tick = 1.0; // latency_now() already returns nanoseconds
+#endif
+}
+
+double latency_ticks_to_ns(uint64_t ticks)
+{
+    return (double)ticks * ns_per_tick;
+}
@@ -0,0 +1,79 @@
+// latency-histogram.h
+// -----------------------------------------------------------------------------
+// Low-overhead log-bucketed latency histogram, one per thread, merged at the
+// end (no shared writes while measuring).
+//
+// Values are raw timestamp ticks (rdtsc on x86, nanoseconds elsewhere).
+// Buckets are log-linear: values below 16 get their own bucket, larger ones
+// are split into 16 sub-buckets per power of two, so any recorded value is
+// reported within 1/16 (6.25%) of its true value, across the whole 64-bit
+// range, in 976 counters.
+//
+//     uint64_t t0 = latency_now();
+//     ... operation ...
+//     latency_record(&hist, latency_now() - t0);
+//
+//     latency_calibrate();   // once, before converting
+//     double p99_ns = latency_ticks_to_ns(latency_percentile(&hist, 99.0));
+//
+// Build: gcc -O2 your-program.c latency-histogram.c
+// -----------------------------------------------------------------------------
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define LATENCY_SUB_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+typedef struct
+{
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t total; // Values recorded
+    uint64_t max;   // Exact largest value
+} latency_histogram_t;
+
+static inline uint64_t latency_now(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc(); // Invariant TSC: constant rate, ~20 cycles
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline unsigned latency_bucket(uint64_t value)
+{
+    if (value < LATENCY_SUB_BUCKETS)
+        return (unsigned)value;
+    unsigned exponent = 63u - (unsigned)__builtin_clzll(value); // >= LATENCY_SUB_BITS
+    unsigned shift = exponent - LATENCY_SUB_BITS;
+    unsigned sub = (unsigned)(value >> shift) & (LATENCY_SUB_BUCKETS - 1);
+    return (shift + 1) * LATENCY_SUB_BUCKETS + sub;
+}
+
+static inline void latency_record(latency_histogram_t *hist, uint64_t value)
+{
+    hist->counts[latency_bucket(value)]++;
+    hist->total++;
+    if (value > hist->max)
+        hist->max = value;
+}
+
+void latency_reset(latency_histogram_t *hist);
+void latency_merge(latency_histogram_t *dst, const latency_histogram_t *src);
+
+// Smallest bucket upper bound covering percentile p (0..100) of the values,
+// clamped to the exact max. 0 for an empty histogram.
+uint64_t latency_percentile(const latency_histogram_t *hist, double p);
+
+// Measure the tick rate against CLOCK_MONOTONIC (~20 ms, call once)
+void latency_calibrate(void);
+double latency_ticks_to_ns(uint64_t ticks);
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,359 @@
+// map-workload.c
+// -----------------------------------------------------------------------------
+// Hash map lookup/replace workload under a reader-writer lock or under
+// epoch-based reclamation (see map-workload.h).
+// -----------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include "map-workload.h"
+#include "epoch.h"
+#include "cpu-topology.h"
+
+#define MAP_VALUE_WORDS 6
+
+typedef struct map_node
+{
+    struct map_node *next;          // Loaded with acquire by lock-free readers
+    uint64_t key;
+    uint64_t version;
+    uint64_t value[MAP_VALUE_WORDS]; // key * (i + 1) + version
+    epoch_entry_t entry;            // Retirement link (epoch protection)
+} map_node_t;
+
+typedef struct
+{
+    map_node_t **buckets;
+    uint64_t mask;
+} hash_map_t;
+
+/* Per-thread state, written only by its own thread while running */
+typedef struct
+{
+    int thread_id;
+    int writer;
+    int cpu;
+    uint64_t rng_state;
+    uint64_t operations;
+    uint64_t bad_reads;
+    latency_histogram_t latency;
+} __attribute__((aligned(64))) map_thread_t;
+
+static hash_map_t map;
+static int protection;
+static rw_lock_t lock;                 // rw backends
+static epoch_domain_t domain;          // epoch
+static pthread_mutex_t writer_mutex = PTHREAD_MUTEX_INITIALIZER; // epoch: writers still serialize
+static const map_workload_t *workload;
+static volatile int stop_requested;
+
+const char *map_protection_name(int protection_id)
+{
+    if (protection_id == MAP_EPOCH)
+        return "epoch";
+    return rw_backend_name((rw_backend_t)protection_id);
+}
+
+int map_protection_parse(const char *name)
+{
+    if (strcmp(name, "epoch") == 0)
+        return MAP_EPOCH;
+    return rw_backend_parse(name);
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: per-thread key choice
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static void do_busy_work(int iterations)
+{
+    volatile unsigned long temp = 0;
+    for (int iterator = 0; iterator < iterations; ++iterator)
+    {
+        temp += iterator ^ (temp << 1);
+    }
+}
+
+static uint64_t bucket_of(uint64_t key)
+{
+    return (key * 0x9e3779b97f4a7c15ULL >> 32) & map.mask;
+}
+
+static void fill_node(map_node_t *node, uint64_t key, uint64_t version, map_node_t *next)
+{
+    node->next = next;
+    node->key = key;
+    node->version = version;
+    for (int iterator = 0; iterator < MAP_VALUE_WORDS; ++iterator)
+    {
+        node->value[iterator] = key * (uint64_t)(iterator + 1) + version;
+    }
+    node->entry.bytes = sizeof(*node);
+}
+
+static void reclaim_node(epoch_entry_t *entry)
+{
+    free((char *)entry - offsetof(map_node_t, entry));
+}
+
+static int map_create(uint64_t num_keys)
+{
+    uint64_t num_buckets = 1;
+    while (num_buckets < num_keys)
+        num_buckets <<= 1;
+    map.mask = num_buckets - 1;
+    map.buckets = calloc(num_buckets, sizeof(map_node_t *));
+    if (map.buckets == NULL)
+        return -1;
+
+    for (uint64_t key = 0; key < num_keys; ++key)
+    {
+        map_node_t *node = malloc(sizeof(*node));
+        if (node == NULL)
+            return -1;
+        uint64_t bucket = bucket_of(key);
+        fill_node(node, key, 0, map.buckets[bucket]);
+        map.buckets[bucket] = node;
+    }
+    return 0;
+}
+
+static void map_free(void)
+{
+    for (uint64_t bucket = 0; map.buckets != NULL && bucket <= map.mask; ++bucket)
+    {
+        map_node_t *node = map.buckets[bucket];
+        while (node != NULL)
+        {
+            map_node_t *next = node->next;
+            free(node);
+            node = next;
+        }
+    }
+    free(map.buckets);
+    map.buckets = NULL;
+}
+
+// Copy the value of key; 0 if missing or inconsistent. Nodes are immutable
+// once published, only the links change, so only they need acquire loads.
+static int map_lookup(uint64_t key, uint64_t *value)
+{
+    map_node_t *node = __atomic_load_n(&map.buckets[bucket_of(key)], __ATOMIC_ACQUIRE);
+    while (node != NULL && node->key != key)
+        node = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+    if (node == NULL)
+        return 0;
+
+    int consistent = 1;
+    for (int iterator = 0; iterator < MAP_VALUE_WORDS; ++iterator)
+    {
+        value[iterator] = node->value[iterator];
+        consistent &= value[iterator] == key * (uint64_t)(iterator + 1) + node->version;
+    }
+    return consistent;
+}
+
+// Publish node as the next version of key (caller excludes other writers).
+// Returns the replaced node, still reachable by readers that already hold it.
+static map_node_t *map_replace(uint64_t key, map_node_t *node)
+{
+    map_node_t **link = &map.buckets[bucket_of(key)];
+    while ((*link)->key != key) // Every key is present
+        link = &(*link)->next;
+    map_node_t *old = *link;
+    fill_node(node, key, old->version + 1, old->next);
+    __atomic_store_n(link, node, __ATOMIC_RELEASE);
+    return old;
+}
+
+static void do_lookup(map_thread_t *self, epoch_thread_t *epoch_self)
+{
+    uint64_t key = next_random(&self->rng_state) % workload->num_keys;
+    uint64_t value[MAP_VALUE_WORDS];
+    int found;
+
+    uint64_t start = latency_now();
+    if (protection == MAP_EPOCH)
+    {
+        epoch_enter(&domain, epoch_self);
+        found = map_lookup(key, value);
+        epoch_exit(epoch_self);
+    }
+    else
+    {
+        unsigned token = rw_read_lock(&lock);
+        found = map_lookup(key, value);
+        rw_read_unlock(&lock, token); // Never asks for a retry: seqlock is rejected
+    }
+    latency_record(&self->latency, latency_now() - start);
+
+    if (!found)
+        self->bad_reads++;
+    self->operations++;
+}
+
+static void do_replace(map_thread_t *self, epoch_thread_t *epoch_self)
+{
+    uint64_t key = next_random(&self->rng_state) % workload->num_keys;
+    map_node_t *node = malloc(sizeof(*node)); // Outside the lock for both protections
+    if (node == NULL)
+        return;
+
+    uint64_t start = latency_now();
+    if (protection == MAP_EPOCH)
+    {
+        pthread_mutex_lock(&writer_mutex);
+        map_node_t *old = map_replace(key, node);
+        pthread_mutex_unlock(&writer_mutex);
+        old->entry.reclaim = reclaim_node;
+        epoch_retire(&domain, epoch_self, &old->entry);
+    }
+    else
+    {
+        rw_write_lock(&lock);
+        map_node_t *old = map_replace(key, node);
+        rw_write_unlock(&lock);
+        free(old); // No reader can hold it once the write lock was taken
+    }
+    latency_record(&self->latency, latency_now() - start);
+    self->operations++;
+}
+
+static void *map_thread(void *arg)
+{
+    map_thread_t *self = (map_thread_t *)arg;
+    int error = cpu_pin_self(self->cpu);
+    if (error != 0)
+        fprintf(stderr, "thread %d: cannot pin to CPU %d: %s\n", self->thread_id, self->cpu, strerror(error));
+
+    epoch_thread_t *epoch_self = protection == MAP_EPOCH ? epoch_register(&domain) : NULL;
+    while (!stop_requested)
+    {
+        if (self->writer)
+        {
+            do_replace(self, epoch_self);
+            do_busy_work(workload->write_think);
+        }
+        else
+        {
+            do_lookup(self, epoch_self);
+        }
+    }
+    return NULL;
+}
+
+// Start the threads, stop them after w->seconds and merge their results
+static void run_threads(const map_workload_t *w, map_thread_t *threads, int num_threads, map_result_t *result)
+{
+    for (int iterator = 0; iterator < num_threads; ++iterator)
+    {
+        map_thread_t *self = &threads[iterator];
+        memset(self, 0, sizeof(*self));
+        self->thread_id = iterator;
+        self->writer = iterator >= w->num_readers;
+        self->cpu = w->cpus != NULL ? w->cpus[iterator] : -1;
+        self->rng_state = 0x9e3779b97f4a7c15ULL * (uint64_t)(iterator + 1);
+    }
+
+    pthread_t handles[num_threads];
+    double start = now_seconds();
+    for (int iterator = 0; iterator < num_threads; ++iterator)
+    {
+        pthread_create(&handles[iterator], NULL, map_thread, &threads[iterator]);
+    }
+    struct timespec ts;
+    ts.tv_sec = (time_t)w->seconds;
+    ts.tv_nsec = (long)((w->seconds - (double)ts.tv_sec) * 1e9);
+    while (nanosleep(&ts, &ts) != 0)
+        ;
+    stop_requested = 1;
+    for (int iterator = 0; iterator < num_threads; ++iterator)
+    {
+        pthread_join(handles[iterator], NULL);
+    }
+    double elapsed = now_seconds() - start;
+
+    uint64_t reads = 0, writes = 0;
+    for (int iterator = 0; iterator < num_threads; ++iterator)
+    {
+        map_thread_t *self = &threads[iterator];
+        if (self->writer)
+        {
+            writes += self->operations;
+            latency_merge(&result->write_latency, &self->latency);
+        }
+        else
+        {
+            reads += self->operations;
+            latency_merge(&result->read_latency, &self->latency);
+        }
+        result->bad_reads += self->bad_reads;
+    }
+    result->reads_per_second = (double)reads / elapsed;
+    result->writes_per_second = (double)writes / elapsed;
+}
+
+int map_workload_run(int protection_id, const map_workload_t *w, map_result_t *result)
+{
+    int num_threads = w->num_readers + w->num_writers;
+    if (protection_id < 0 || protection_id >= MAP_PROTECTION_COUNT || protection_id == RW_SEQLOCK ||
+        num_threads < 1 || w->num_keys == 0 || w->seconds <= 0.0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(result, 0, sizeof(*result));
+    protection = protection_id;
+    workload = w;
+    stop_requested = 0;
+
+    if (protection == MAP_EPOCH ? epoch_domain_init(&domain, num_threads) < 0
+                                : rw_lock_init(&lock, (rw_backend_t)protection) < 0)
+        return -1;
+
+    int status = -1;
+    map_thread_t *threads = NULL;
+    if (map_create(w->num_keys) == 0 &&
+        posix_memalign((void **)&threads, 64, (size_t)num_threads * sizeof(map_thread_t)) == 0)
+    {
+        run_threads(w, threads, num_threads, result);
+        if (protection == MAP_EPOCH)
+        {
+            result->peak_deferred_bytes = domain.peak_deferred_bytes;
+            result->peak_deferred_nodes = domain.peak_deferred_nodes;
+        }
+        status = 0;
+    }
+    else
+    {
+        threads = NULL;
+        errno = ENOMEM;
+    }
+
+    if (protection == MAP_EPOCH)
+        epoch_domain_destroy(&domain); // Frees what is still retired, before the live nodes
+    else
+        rw_lock_destroy(&lock);
+    map_free();
+    free(threads);
+    return status;
+}
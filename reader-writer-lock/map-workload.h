@@ -0,0 +1,63 @@
+// map-workload.h
+// -----------------------------------------------------------------------------
+// Read-mostly hash map workload: readers look up random keys and copy the
+// value, writers replace the entry of a random key with a new version.
+//
+// The same chained map is protected two ways:
+//
+//   protection     readers                         writers
+//   <rw backend>   rw_read_lock around the lookup  write lock, swap node, free old
+//   epoch          no lock, epoch_enter/exit only  one mutex, publish new node,
+//                                                  retire old one (epoch.h)
+//
+// With epoch protection a reader writes only its own epoch slot, so read
+// throughput is not limited by a shared lock word; the price is memory held
+// by retired nodes until every reader has moved on, which is reported as the
+// peak of deferred bytes/nodes.
+//
+// Every value carries its key and version in all words, so a reader can tell
+// a torn or freed node (counted as bad_reads, must stay 0).
+//
+// Build: gcc -O2 -pthread your-program.c map-workload.c epoch.c rw-backend.c
+//            futex-rwlock.c percpu-rwlock.c bravo-rwlock.c latency-histogram.c
+// -----------------------------------------------------------------------------
+
+#ifndef MAP_WORKLOAD_H
+#define MAP_WORKLOAD_H
+
+#include <stdint.h>
+#include "rw-backend.h"
+#include "latency-histogram.h"
+
+#define MAP_EPOCH RW_BACKEND_COUNT // Protection ids: rw_backend_t values, then this
+#define MAP_PROTECTION_COUNT (RW_BACKEND_COUNT + 1)
+
+typedef struct
+{
+    int num_readers;
+    int num_writers;
+    uint64_t num_keys;
+    int write_think;   // Busy-loop iterations between writes
+    double seconds;
+    const int *cpus;   // CPU per thread (readers, then writers), -1 = unpinned; NULL = none
+} map_workload_t;
+
+typedef struct
+{
+    double reads_per_second;
+    double writes_per_second;
+    latency_histogram_t read_latency;  // Whole lookup, ticks
+    latency_histogram_t write_latency; // Lock (or mutex) wait + replace + free or retire
+    uint64_t peak_deferred_bytes;      // Epoch only: retired but not yet freed
+    uint64_t peak_deferred_nodes;
+    uint64_t bad_reads;                // Missing key or inconsistent value
+} map_result_t;
+
+const char *map_protection_name(int protection);
+int map_protection_parse(const char *name); // -1 if unknown
+
+// Run the workload once. Returns 0, or -1 (errno set; EINVAL for seqlock,
+// whose optimistic readers could follow a pointer into a freed node).
+int map_workload_run(int protection, const map_workload_t *w, map_result_t *result);
+
+#endif // MAP_WORKLOAD_H
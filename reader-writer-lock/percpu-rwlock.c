@@ -0,0 +1,100 @@
+// percpu-rwlock.c
+// -----------------------------------------------------------------------------
+// Per-CPU reader slots with writer drain (see percpu-rwlock.h).
+// -----------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "percpu-rwlock.h"
+#include "cpu-relax.h"
+
+#define SPINS_BEFORE_YIELD 1024
+
+static void backoff(unsigned *spins)
+{
+    if (++*spins < SPINS_BEFORE_YIELD)
+    {
+        cpu_relax();
+    }
+    else
+    {
+        *spins = 0;
+        sched_yield();
+    }
+}
+
+int percpu_rwlock_init(percpu_rwlock_t *lock)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    lock->num_slots = cpus > 0 ? (unsigned)cpus : 1;
+    void *slots;
+    if (posix_memalign(&slots, PERCPU_RW_CACHE_LINE, lock->num_slots * sizeof(percpu_rw_slot_t)) != 0)
+        return -1;
+    lock->slots = slots;
+    for (unsigned iterator = 0; iterator < lock->num_slots; iterator++)
+    {
+        lock->slots[iterator].readers = 0;
+    }
+    lock->writer = 0;
+    return pthread_mutex_init(&lock->writer_mutex, NULL) == 0 ? 0 : -1;
+}
+
+void percpu_rwlock_destroy(percpu_rwlock_t *lock)
+{
+    pthread_mutex_destroy(&lock->writer_mutex);
+    free(lock->slots);
+    lock->slots = NULL;
+}
+
+unsigned percpu_rwlock_rdlock(percpu_rwlock_t *lock)
+{
+    unsigned spins = 0;
+    for (;;)
+    {
+        int cpu = sched_getcpu(); // vDSO / rseq: no system call
+        unsigned slot = cpu >= 0 ? (unsigned)cpu % lock->num_slots : 0;
+
+        // Sequentially consistent: the increment must be visible before we
+        // look at the flag, pairing with the writer's store-then-scan
+        __atomic_fetch_add(&lock->slots[slot].readers, 1, __ATOMIC_SEQ_CST);
+        if (!__atomic_load_n(&lock->writer, __ATOMIC_SEQ_CST))
+            return slot;
+
+        /* A writer is active: back out so it can drain, wait, retry */
+        __atomic_fetch_sub(&lock->slots[slot].readers, 1, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&lock->writer, __ATOMIC_RELAXED))
+        {
+            backoff(&spins);
+        }
+    }
+}
+
+void percpu_rwlock_rdunlock(percpu_rwlock_t *lock, unsigned slot)
+{
+    __atomic_fetch_sub(&lock->slots[slot].readers, 1, __ATOMIC_RELEASE);
+}
+
+void percpu_rwlock_wrlock(percpu_rwlock_t *lock)
+{
+    pthread_mutex_lock(&lock->writer_mutex);
+    __atomic_store_n(&lock->writer, 1, __ATOMIC_SEQ_CST);
+
+    unsigned spins = 0;
+    for (unsigned iterator = 0; iterator < lock->num_slots; iterator++)
+    {
+        // The other half of rdlock's pairing: seq_cst so that no slot is
+        // read before writer = 1 is visible
+        while (__atomic_load_n(&lock->slots[iterator].readers, __ATOMIC_SEQ_CST) != 0)
+        {
+            backoff(&spins);
+        }
+    }
+}
+
+void percpu_rwlock_wrunlock(percpu_rwlock_t *lock)
+{
+    __atomic_store_n(&lock->writer, 0, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&lock->writer_mutex);
+}
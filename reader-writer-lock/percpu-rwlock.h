@@ -0,0 +1,52 @@
+// percpu-rwlock.h
+// -----------------------------------------------------------------------------
+// Distributed ("big-reader") reader-writer lock.
+//
+// pthread_rwlock keeps one reader count, so every rdlock/unlock from every
+// core writes the same cache line and read throughput stops scaling. Here each
+// CPU has its own reader counter on its own cache line:
+//
+//   reader:  count[cpu]++, then check the writer flag; if a writer is active,
+//            back out (count[cpu]--) and wait for it to finish
+//   writer:  take the writer mutex, raise the writer flag, then wait until
+//            every per-CPU count has drained to zero
+//
+// Readers touch only their CPU's line, so reads scale with cores; writers pay
+// O(number of CPUs) to drain. This suits read-mostly data with rare writes.
+// Writers are preferred: once the flag is up no new reader gets in.
+//
+// A reader may migrate between lock and unlock, so rdlock returns the slot
+// it incremented and rdunlock takes it back.
+// -----------------------------------------------------------------------------
+
+#ifndef PERCPU_RWLOCK_H
+#define PERCPU_RWLOCK_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#define PERCPU_RW_CACHE_LINE 64
+
+typedef struct
+{
+    uint32_t readers;
+    char pad[PERCPU_RW_CACHE_LINE - sizeof(uint32_t)];
+} __attribute__((aligned(PERCPU_RW_CACHE_LINE))) percpu_rw_slot_t;
+
+typedef struct
+{
+    percpu_rw_slot_t *slots; // One per possible CPU
+    unsigned num_slots;
+    uint32_t writer; // 1 while a writer holds or is draining
+    pthread_mutex_t writer_mutex;
+} percpu_rwlock_t;
+
+int percpu_rwlock_init(percpu_rwlock_t *lock);   // 0 or -1 (errno set)
+void percpu_rwlock_destroy(percpu_rwlock_t *lock);
+
+unsigned percpu_rwlock_rdlock(percpu_rwlock_t *lock); // Returns the slot to pass back
+void percpu_rwlock_rdunlock(percpu_rwlock_t *lock, unsigned slot);
+void percpu_rwlock_wrlock(percpu_rwlock_t *lock);
+void percpu_rwlock_wrunlock(percpu_rwlock_t *lock);
+
+#endif // PERCPU_RWLOCK_H
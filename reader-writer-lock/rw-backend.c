@@ -0,0 +1,208 @@
+// rw-backend.c
+// -----------------------------------------------------------------------------
+// Backend dispatch for the reader/writer locking interface (see rw-backend.h).
+// -----------------------------------------------------------------------------
+
+#include <string.h>
+#include <errno.h>
+#include "rw-backend.h"
+
+const char *rw_backend_name(rw_backend_t backend)
+{
+    switch (backend)
+    {
+    case RW_PTHREAD_RWLOCK:
+        return "pthread-rwlock";
+    case RW_PTHREAD_MUTEX:
+        return "pthread-mutex";
+    case RW_TICKET:
+        return "ticket";
+    case RW_SEQLOCK:
+        return "seqlock";
+    case RW_FUTEX_RWLOCK:
+        return "futex-rwlock";
+    case RW_PERCPU_RWLOCK:
+        return "percpu-rwlock";
+    case RW_BRAVO:
+        return "bravo";
+    default:
+        return "unknown";
+    }
+}
+
+int rw_backend_parse(const char *name)
+{
+    for (int backend = 0; backend < RW_BACKEND_COUNT; backend++)
+    {
+        if (strcmp(name, rw_backend_name((rw_backend_t)backend)) == 0)
+            return backend;
+    }
+    return -1;
+}
+
+int rw_lock_init(rw_lock_t *lock, rw_backend_t backend)
+{
+    memset(lock, 0, sizeof(*lock));
+    lock->backend = backend;
+
+    switch (backend)
+    {
+    case RW_PTHREAD_RWLOCK:
+        return pthread_rwlock_init(&lock->u.rwlock, NULL) == 0 ? 0 : -1;
+    case RW_PTHREAD_MUTEX:
+        return pthread_mutex_init(&lock->u.mutex, NULL) == 0 ? 0 : -1;
+    case RW_TICKET:
+        lock->u.ticket = (ticket_lock_t)TICKET_LOCK_INITIALIZER;
+        return 0;
+    case RW_SEQLOCK:
+        lock->u.seqlock = (seqlock_t)SEQLOCK_INITIALIZER;
+        return 0;
+    case RW_FUTEX_RWLOCK:
+        lock->u.futex = (futex_rwlock_t)FUTEX_RWLOCK_INITIALIZER;
+        return 0;
+    case RW_PERCPU_RWLOCK:
+        return percpu_rwlock_init(&lock->u.percpu);
+    case RW_BRAVO:
+        return bravo_rwlock_init(&lock->u.bravo);
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+}
+
+void rw_lock_destroy(rw_lock_t *lock)
+{
+    switch (lock->backend)
+    {
+    case RW_PTHREAD_RWLOCK:
+        pthread_rwlock_destroy(&lock->u.rwlock);
+        break;
+    case RW_PTHREAD_MUTEX:
+        pthread_mutex_destroy(&lock->u.mutex);
+        break;
+    case RW_PERCPU_RWLOCK:
+        percpu_rwlock_destroy(&lock->u.percpu);
+        break;
+    case RW_BRAVO:
+        bravo_rwlock_destroy(&lock->u.bravo);
+        break;
+    default:
+        break; // Nothing allocated
+    }
+}
+
+unsigned rw_read_lock(rw_lock_t *lock)
+{
+    switch (lock->backend)
+    {
+    case RW_PTHREAD_RWLOCK:
+        pthread_rwlock_rdlock(&lock->u.rwlock);
+        return 0;
+    case RW_PTHREAD_MUTEX:
+        pthread_mutex_lock(&lock->u.mutex);
+        return 0;
+    case RW_TICKET:
+        ticket_lock(&lock->u.ticket);
+        return 0;
+    case RW_SEQLOCK:
+        return seqlock_read_begin(&lock->u.seqlock);
+    case RW_FUTEX_RWLOCK:
+        futex_rwlock_rdlock(&lock->u.futex);
+        return 0;
+    case RW_PERCPU_RWLOCK:
+        return percpu_rwlock_rdlock(&lock->u.percpu);
+    case RW_BRAVO:
+        return bravo_rwlock_rdlock(&lock->u.bravo);
+    default:
+        return 0;
+    }
+}
+
+int rw_read_unlock(rw_lock_t *lock, unsigned token)
+{
+    switch (lock->backend)
+    {
+    case RW_PTHREAD_RWLOCK:
+        pthread_rwlock_unlock(&lock->u.rwlock);
+        return 0;
+    case RW_PTHREAD_MUTEX:
+        pthread_mutex_unlock(&lock->u.mutex);
+        return 0;
+    case RW_TICKET:
+        ticket_unlock(&lock->u.ticket);
+        return 0;
+    case RW_SEQLOCK:
+        return seqlock_read_retry(&lock->u.seqlock, token);
+    case RW_FUTEX_RWLOCK:
+        futex_rwlock_rdunlock(&lock->u.futex);
+        return 0;
+    case RW_PERCPU_RWLOCK:
+        percpu_rwlock_rdunlock(&lock->u.percpu, token);
+        return 0;
+    case RW_BRAVO:
+        bravo_rwlock_rdunlock(&lock->u.bravo, token);
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+void rw_write_lock(rw_lock_t *lock)
+{
+    switch (lock->backend)
+    {
+    case RW_PTHREAD_RWLOCK:
+        pthread_rwlock_wrlock(&lock->u.rwlock);
+        break;
+    case RW_PTHREAD_MUTEX:
+        pthread_mutex_lock(&lock->u.mutex);
+        break;
+    case RW_TICKET:
+        ticket_lock(&lock->u.ticket);
+        break;
+    case RW_SEQLOCK:
+        seqlock_write_lock(&lock->u.seqlock);
+        break;
+    case RW_FUTEX_RWLOCK:
+        futex_rwlock_wrlock(&lock->u.futex);
+        break;
+    case RW_PERCPU_RWLOCK:
+        percpu_rwlock_wrlock(&lock->u.percpu);
+        break;
+    case RW_BRAVO:
+        bravo_rwlock_wrlock(&lock->u.bravo);
+        break;
+    default:
+        break;
+    }
+}
+
+void rw_write_unlock(rw_lock_t *lock)
+{
+    switch (lock->backend)
+    {
+    case RW_PTHREAD_RWLOCK:
+        pthread_rwlock_unlock(&lock->u.rwlock);
+        break;
+    case RW_PTHREAD_MUTEX:
+        pthread_mutex_unlock(&lock->u.mutex);
+        break;
+    case RW_TICKET:
+        ticket_unlock(&lock->u.ticket);
+        break;
+    case RW_SEQLOCK:
+        seqlock_write_unlock(&lock->u.seqlock);
+        break;
+    case RW_FUTEX_RWLOCK:
+        futex_rwlock_wrunlock(&lock->u.futex);
+        break;
+    case RW_PERCPU_RWLOCK:
+        percpu_rwlock_wrunlock(&lock->u.percpu);
+        break;
+    case RW_BRAVO:
+        bravo_rwlock_wrunlock(&lock->u.bravo);
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,78 @@
+// rw-backend.h
+// -----------------------------------------------------------------------------
+// One reader/writer locking interface over several primitives, so the
+// rwlock.c workload can be measured with each of them:
+//
+//   backend           readers            writers          waiting
+//   pthread-rwlock    shared             exclusive        glibc (futex)
+//   pthread-mutex     exclusive          exclusive        glibc (futex)
+//   ticket            exclusive, FIFO    exclusive, FIFO  spin
+//   seqlock           optimistic, retry  exclusive        spin
+//   futex-rwlock      shared             exclusive        adaptive spin, then park
+//   percpu-rwlock     per-CPU counters   drain all CPUs   spin
+//   bravo             biased table slot  revoke bias      pthread-rwlock + spin
+//
+// Readers use a token so optimistic backends fit the same loop:
+//
+//     unsigned token;
+//     do {
+//         token = rw_read_lock(lock);
+//         ... read shared data with relaxed atomic loads ...
+//     } while (rw_read_unlock(lock, token));
+//
+// Build: gcc -O2 -pthread your-program.c rw-backend.c futex-rwlock.c
+//            percpu-rwlock.c bravo-rwlock.c
+// -----------------------------------------------------------------------------
+
+#ifndef RW_BACKEND_H
+#define RW_BACKEND_H
+
+#include <pthread.h>
+#include "ticket-lock.h"
+#include "seqlock.h"
+#include "futex-rwlock.h"
+#include "percpu-rwlock.h"
+#include "bravo-rwlock.h"
+
+typedef enum
+{
+    RW_PTHREAD_RWLOCK,
+    RW_PTHREAD_MUTEX,
+    RW_TICKET,
+    RW_SEQLOCK,
+    RW_FUTEX_RWLOCK,
+    RW_PERCPU_RWLOCK,
+    RW_BRAVO,
+    RW_BACKEND_COUNT
+} rw_backend_t;
+
+typedef struct
+{
+    rw_backend_t backend;
+    union
+    {
+        pthread_rwlock_t rwlock;
+        pthread_mutex_t mutex;
+        ticket_lock_t ticket;
+        seqlock_t seqlock;
+        futex_rwlock_t futex;
+        percpu_rwlock_t percpu;
+        bravo_rwlock_t bravo;
+    } u;
+} rw_lock_t;
+
+const char *rw_backend_name(rw_backend_t backend);
+int rw_backend_parse(const char *name); // rw_backend_t, or -1 if unknown
+
+int rw_lock_init(rw_lock_t *lock, rw_backend_t backend); // 0 or -1 (errno set)
+void rw_lock_destroy(rw_lock_t *lock);
+
+// rw_read_unlock() returns nonzero when the read section saw a concurrent
+// write and must be repeated (seqlock only; the others always return 0)
+unsigned rw_read_lock(rw_lock_t *lock);
+int rw_read_unlock(rw_lock_t *lock, unsigned token);
+
+void rw_write_lock(rw_lock_t *lock);
+void rw_write_unlock(rw_lock_t *lock);
+
+#endif // RW_BACKEND_H
@@ -1,21 +1,139 @@
+/*
+ * Reader-writer lock benchmark
+ *
+ * Readers and writers hammer one shared record for a fixed time: readers copy
+ * all of its fields and check they belong to the same version, writers
+ * replace them. The lock protecting it is selectable (see rw-backend.h):
+ * pthread-rwlock (default), pthread-mutex, ticket, seqlock, futex-rwlock,
+ * percpu-rwlock, bravo.
+ *
+ * With the seqlock backend readers never write shared memory: they copy the
+ * record optimistically and retry if a writer ran meanwhile, so read
+ * throughput scales with cores as long as writes stay rare.
+ *
+ * Every thread records the time it waits to acquire the lock and the time it
+ * holds it into its own log-bucketed histogram (latency-histogram.h); the
+ * single-run report merges them into p50/p99/p99.9/max per role and lists the
+ * per-thread op counts, which expose writer starvation and unfairness.
+ *
+ * "scale" mode repeats the run with 1 .. all online CPUs as readers for each
+ * given lock (default: pthread-rwlock, percpu-rwlock, bravo) to show where
+ * read throughput stops scaling.
+ *
+ * "sweep" mode runs every combination of lock, thread count, write
+ * percentage, critical-section length and think time (both in do_busy_work()
+ * iterations) with a warmup and repeated trials, and writes one CSV row or
+ * JSON object per combination with means and 95% confidence intervals - ready
+ * for plotting scaling curves. Progress goes to stderr.
+ *
+ * "map" mode swaps the single record for a hash map of MAP_KEYS entries:
+ * readers look up random keys, writers replace entries with a new version.
+ * It compares lock-protected lookups (any backend but seqlock) with "epoch",
+ * where readers take no lock and writers retire replaced entries through
+ * epoch-based reclamation (epoch.h), and reports read throughput, write
+ * latency and the peak memory waiting in deferred frees.
+ *
+ * --placement pins every thread with pthread_setaffinity_np() following a
+ * policy computed from the /sys topology (cpu-topology.h): compact, scatter,
+ * one per physical core, or only the NUMA node main() runs on. The topology
+ * map and the thread -> CPU plan are printed first, so runs on multi-socket
+ * machines are reproducible and the cost of crossing sockets is visible.
+ *
+ * Build: gcc -O2 -pthread rwlock.c rw-backend.c futex-rwlock.c percpu-rwlock.c bravo-rwlock.c \
+ *            latency-histogram.c sharded-counter.c cpu-topology.c map-workload.c epoch.c -o rwlock -lm
+ * Usage: ./rwlock <num_readers> <num_writers> <runtime_seconds> [lock]
+ *        ./rwlock scale <num_writers> <seconds_per_step> [lock ...]
+ *        ./rwlock map <num_readers> <num_writers> <seconds> [lock|epoch ...]
+ *        ./rwlock sweep [--locks a,b] [--threads 1,2,4] [--write-percent 0,1,10]
+ *                       [--cs 0,100] [--think 100,1000] [--seconds s] [--warmup s]
+ *                       [--trials n] [--format csv|json]
+ *        (every mode) --placement none|compact|scatter|physical|numa-node
+ */
+
 #define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <pthread.h>
 #include <time.h>
-#include <stdatomic.h>
 #include <unistd.h>
+#include "rw-backend.h"
+#include "latency-histogram.h"
+#include "sharded-counter.h"
+#include "cpu-topology.h"
+#include "map-workload.h"
+
+#define SHARED_FIELDS 6
+#define MAP_KEYS 65536
+
+static rw_lock_t rwlock;
+
+/*
+ * The protected record: a small read-mostly "config snapshot" of several
+ * fields that must be seen together. Every write derives all fields from the
+ * new counter, so a reader can tell a torn (half-updated) copy.
+ */
+typedef struct
+{
+    uint64_t counter;               // Number of writes so far
+    uint64_t values[SHARED_FIELDS]; // counter * (i + 1)
+    uint64_t checksum;              // XOR of all fields above
+} __attribute__((aligned(64))) shared_state_t;
+
+static shared_state_t shared_state;
 
-static pthread_rwlock_t rwlock = PTHREAD_RWLOCK_INITIALIZER;
-static int shared_counter = 0;
-static atomic_ulong total_reader_operations = 0;
-static atomic_ulong total_writer_operations = 0;
+/* One cache-line shard per thread (shard = thread_id): no shared line is written per op */
+static sharded_counter_t reader_operations;
+static sharded_counter_t writer_operations;
+static sharded_counter_t read_retries; // Seqlock: reads repeated after a concurrent write
+static sharded_counter_t torn_reads;   // Inconsistent snapshots (must stay 0)
 static volatile int stop_requested = 0;
 
+/* Workload shape: who runs, and how long they work inside and outside the lock */
+typedef struct
+{
+    int num_readers;       // Threads that only read
+    int num_writers;       // Threads that only write
+    int num_mixed;         // Threads that write write_percent of their ops
+    int write_percent;     // For the mixed threads
+    int read_cs;           // do_busy_work() iterations while holding the lock
+    int write_cs;
+    int read_think;        // do_busy_work() iterations between operations
+    int write_think;
+    double warmup_seconds; // Threads run but nothing is recorded
+    double seconds;        // Measured interval
+} workload_t;
+
+/* Per-thread results, written only by their own thread while running */
 typedef struct
 {
     int thread_id;
-} thread_arg_t;
+    int write_percent;  // 0 = reader, 100 = writer
+    int cpu;            // Pinned CPU, -1 = not pinned
+    uint64_t rng_state; // Picks read or write for mixed threads
+    latency_histogram_t read_wait;  // rdlock call until acquired
+    latency_histogram_t read_hold;  // Acquired until unlock returned
+    latency_histogram_t write_wait; // Same for writes
+    latency_histogram_t write_hold;
+} __attribute__((aligned(64))) thread_arg_t;
+
+/* Merged outcome of one run */
+typedef struct
+{
+    double reads_per_second;
+    double writes_per_second;
+    double read_wait_p99_ns;
+    double write_wait_p99_ns;
+    double fairness; // Jain's index over per-thread op counts
+    uint64_t torn_reads;
+} run_result_t;
+
+static workload_t workload;
+static placement_t placement = PLACEMENT_NONE;
+static cpu_topology_t topology;
+static thread_arg_t *thread_args; // Readers, then writers, then mixed
+static volatile int measuring = 0; // Set after the warmup
 
 static void do_busy_work(int iterations)
 {
@@ -26,75 +144,798 @@ static void do_busy_work(int iterations)
     }
 }
 
-static void *reader_thread(void *arg)
+static void sleep_seconds(double seconds)
 {
-    (void)arg;
-    while (!stop_requested)
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - (double)ts.tv_sec) * 1e9);
+    while (nanosleep(&ts, &ts) != 0)
+        ;
+}
+
+// xorshift64: per-thread read/write choice
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static void make_state(shared_state_t *state, uint64_t counter)
+{
+    state->counter = counter;
+    state->checksum = counter;
+    for (int iterator = 0; iterator < SHARED_FIELDS; ++iterator)
     {
-        pthread_rwlock_rdlock(&rwlock);
-        int local_value = shared_counter;
-        (void)local_value;
-        atomic_fetch_add(&total_reader_operations, 1);
-        pthread_rwlock_unlock(&rwlock);
-        do_busy_work(100);
+        state->values[iterator] = counter * (uint64_t)(iterator + 1);
+        state->checksum ^= state->values[iterator];
     }
-    return NULL;
 }
 
-static void *writer_thread(void *arg)
+static int state_is_consistent(const shared_state_t *state)
+{
+    shared_state_t expected;
+    make_state(&expected, state->counter);
+    return memcmp(&expected, state, sizeof(expected)) == 0;
+}
+
+static void do_read(thread_arg_t *targ, int record)
 {
-    (void)arg;
+    shared_state_t snapshot;
+    int attempts = 0;
+    uint64_t start = latency_now();
+    unsigned token = rw_read_lock(&rwlock);
+    uint64_t acquired = latency_now();
+    for (;;)
+    {
+        // Word-wise relaxed loads: seqlock readers may race a writer
+        seqlock_load_words(&snapshot, &shared_state, sizeof(snapshot));
+        do_busy_work(workload.read_cs);
+        attempts++;
+        if (!rw_read_unlock(&rwlock, token))
+            break;
+        token = rw_read_lock(&rwlock); // Seqlock retry: counted as hold time
+    }
+    uint64_t released = latency_now();
+
+    int torn = !state_is_consistent(&snapshot);
+    if (torn)
+        sharded_counter_add_owned(&torn_reads, (unsigned)targ->thread_id, 1); // Counted even in warmup
+    if (!record)
+        return;
+    latency_record(&targ->read_wait, acquired - start);
+    latency_record(&targ->read_hold, released - acquired);
+    if (attempts > 1)
+        sharded_counter_add_owned(&read_retries, (unsigned)targ->thread_id, (uint64_t)(attempts - 1));
+    sharded_counter_add_owned(&reader_operations, (unsigned)targ->thread_id, 1);
+}
+
+static void do_write(thread_arg_t *targ, int record)
+{
+    uint64_t start = latency_now();
+    rw_write_lock(&rwlock);
+    uint64_t acquired = latency_now();
+    shared_state_t next;
+    make_state(&next, shared_state.counter + 1);
+    seqlock_store_words(&shared_state, &next, sizeof(next));
+    do_busy_work(workload.write_cs);
+    rw_write_unlock(&rwlock);
+    uint64_t released = latency_now();
+
+    if (!record)
+        return;
+    latency_record(&targ->write_wait, acquired - start);
+    latency_record(&targ->write_hold, released - acquired);
+    sharded_counter_add_owned(&writer_operations, (unsigned)targ->thread_id, 1);
+}
+
+static void *worker_thread(void *arg)
+{
+    thread_arg_t *targ = (thread_arg_t *)arg;
+    int error = cpu_pin_self(targ->cpu);
+    if (error != 0)
+        fprintf(stderr, "thread %d: cannot pin to CPU %d: %s\n", targ->thread_id, targ->cpu, strerror(error));
+
     while (!stop_requested)
     {
-        pthread_rwlock_wrlock(&rwlock);
-        shared_counter++;
-        atomic_fetch_add(&total_writer_operations, 1);
-        pthread_rwlock_unlock(&rwlock);
-        do_busy_work(1000);
+        int record = measuring;
+        int write = targ->write_percent >= 100 ||
+                    (targ->write_percent > 0 && next_random(&targ->rng_state) % 100 < (uint64_t)targ->write_percent);
+        if (write)
+        {
+            do_write(targ, record);
+            do_busy_work(workload.write_think);
+        }
+        else
+        {
+            do_read(targ, record);
+            do_busy_work(workload.read_think);
+        }
     }
     return NULL;
 }
 
+static int total_threads(const workload_t *w)
+{
+    return w->num_readers + w->num_writers + w->num_mixed;
+}
+
+/*
+ * Run the workload once with a fresh lock of the given backend.
+ * Results are left in the counters and thread_args. Returns 0 or -1.
+ */
+static int run_workload(rw_backend_t backend, const workload_t *w)
+{
+    int num_threads = total_threads(w);
+    workload = *w;
+    if (rw_lock_init(&rwlock, backend) < 0)
+    {
+        perror("rw_lock_init");
+        return -1;
+    }
+    make_state(&shared_state, 0);
+    sharded_counter_t *counters[] = {&reader_operations, &writer_operations, &read_retries, &torn_reads};
+    for (int iterator = 0; iterator < 4; ++iterator)
+    {
+        sharded_counter_destroy(counters[iterator]);
+        if (sharded_counter_init(counters[iterator], (unsigned)num_threads) < 0)
+        {
+            perror("sharded_counter_init");
+            return -1;
+        }
+    }
+    stop_requested = 0;
+    measuring = w->warmup_seconds <= 0.0;
+
+    free(thread_args);
+    if (posix_memalign((void **)&thread_args, 64, (size_t)num_threads * sizeof(thread_arg_t)) != 0)
+    {
+        thread_args = NULL;
+        perror("posix_memalign");
+        return -1;
+    }
+    int cpus[num_threads];
+    cpu_topology_plan(&topology, placement, num_threads, cpus);
+    for (int iterator = 0; iterator < num_threads; ++iterator)
+    {
+        thread_arg_t *targ = &thread_args[iterator];
+        targ->thread_id = iterator;
+        targ->cpu = cpus[iterator];
+        targ->write_percent = iterator < w->num_readers                  ? 0
+                              : iterator < w->num_readers + w->num_writers ? 100
+                                                                           : w->write_percent;
+        targ->rng_state = 0x9e3779b97f4a7c15ULL * (uint64_t)(iterator + 1);
+        latency_reset(&targ->read_wait);
+        latency_reset(&targ->read_hold);
+        latency_reset(&targ->write_wait);
+        latency_reset(&targ->write_hold);
+    }
+
+    pthread_t threads[num_threads];
+    for (int iterator = 0; iterator < num_threads; ++iterator)
+    {
+        pthread_create(&threads[iterator], NULL, worker_thread, &thread_args[iterator]);
+    }
+
+    if (w->warmup_seconds > 0.0)
+    {
+        sleep_seconds(w->warmup_seconds);
+        measuring = 1;
+    }
+    sleep_seconds(w->seconds);
+    stop_requested = 1;
+
+    for (int iterator = 0; iterator < num_threads; ++iterator)
+    {
+        pthread_join(threads[iterator], NULL);
+    }
+
+    rw_lock_destroy(&rwlock);
+    return 0;
+}
+
+static uint64_t thread_operations(int thread)
+{
+    return sharded_counter_read(&reader_operations, (unsigned)thread) +
+           sharded_counter_read(&writer_operations, (unsigned)thread);
+}
+
+// Jain's fairness index (sum x)^2 / (n * sum x^2): 1.0 = even, 1/n = one thread did everything
+static double fairness_index(int first, int count)
+{
+    double sum = 0.0, sum_squares = 0.0;
+    for (int iterator = first; iterator < first + count; ++iterator)
+    {
+        double ops = (double)thread_operations(iterator);
+        sum += ops;
+        sum_squares += ops * ops;
+    }
+    return sum_squares > 0.0 ? sum * sum / ((double)count * sum_squares) : 1.0;
+}
+
+static void merge_histograms(int num_threads, latency_histogram_t *read_wait, latency_histogram_t *read_hold,
+                             latency_histogram_t *write_wait, latency_histogram_t *write_hold)
+{
+    latency_reset(read_wait);
+    latency_reset(read_hold);
+    latency_reset(write_wait);
+    latency_reset(write_hold);
+    for (int iterator = 0; iterator < num_threads; ++iterator)
+    {
+        latency_merge(read_wait, &thread_args[iterator].read_wait);
+        latency_merge(read_hold, &thread_args[iterator].read_hold);
+        latency_merge(write_wait, &thread_args[iterator].write_wait);
+        latency_merge(write_hold, &thread_args[iterator].write_hold);
+    }
+}
+
+static void collect_result(const workload_t *w, run_result_t *result)
+{
+    static latency_histogram_t read_wait, read_hold, write_wait, write_hold;
+    merge_histograms(total_threads(w), &read_wait, &read_hold, &write_wait, &write_hold);
+    result->reads_per_second = (double)sharded_counter_sum(&reader_operations) / w->seconds;
+    result->writes_per_second = (double)sharded_counter_sum(&writer_operations) / w->seconds;
+    result->read_wait_p99_ns = latency_ticks_to_ns(latency_percentile(&read_wait, 99.0));
+    result->write_wait_p99_ns = latency_ticks_to_ns(latency_percentile(&write_wait, 99.0));
+    result->fairness = fairness_index(0, total_threads(w));
+    result->torn_reads = sharded_counter_sum(&torn_reads);
+}
+
+static void print_latency_row(const char *name, const latency_histogram_t *hist)
+{
+    printf("%-13s %10.0f %10.0f %10.0f %10.0f %10.0f\n", name, latency_ticks_to_ns(latency_percentile(hist, 50.0)),
+           latency_ticks_to_ns(latency_percentile(hist, 99.0)), latency_ticks_to_ns(latency_percentile(hist, 99.9)),
+           latency_ticks_to_ns(hist->max), (double)hist->total);
+}
+
+/*
+ * Per-thread operation counts of one role, with min/max and Jain's
+ * fairness index.
+ */
+static void print_fairness(const char *role, int first, int count)
+{
+    if (count == 0)
+        return;
+    uint64_t min = UINT64_MAX, max = 0;
+    printf("%s ops:", role);
+    for (int iterator = first; iterator < first + count; ++iterator)
+    {
+        uint64_t ops = thread_operations(iterator);
+        printf(" %lu", (unsigned long)ops);
+        min = ops < min ? ops : min;
+        max = ops > max ? ops : max;
+    }
+    printf("\n  min %lu, max %lu, fairness %.3f\n", (unsigned long)min, (unsigned long)max,
+           fairness_index(first, count));
+}
+
+/*
+ * Merge the per-thread histograms and print acquire-wait and hold time
+ * percentiles per operation type, then per-thread op counts.
+ */
+static void print_latency_report(const workload_t *w)
+{
+    static latency_histogram_t read_wait, read_hold, write_wait, write_hold;
+    merge_histograms(total_threads(w), &read_wait, &read_hold, &write_wait, &write_hold);
+
+    printf("\n%-13s %10s %10s %10s %10s %10s\n", "latency (ns)", "p50", "p99", "p99.9", "max", "samples");
+    print_latency_row("reader wait", &read_wait);
+    print_latency_row("reader hold", &read_hold);
+    print_latency_row("writer wait", &write_wait);
+    print_latency_row("writer hold", &write_hold);
+    printf("\n");
+    print_fairness("reader", 0, w->num_readers);
+    print_fairness("writer", w->num_readers, w->num_writers);
+    print_fairness("mixed", w->num_readers + w->num_writers, w->num_mixed);
+}
+
+/*
+ * Topology map and, for a placement policy, the CPU each thread gets
+ * (readers first, then writers, then mixed threads).
+ */
+static void print_placement(FILE *out, int num_threads)
+{
+    cpu_topology_print(&topology, out);
+    fprintf(out, "placement: %s", placement_name(placement));
+    if (placement != PLACEMENT_NONE && num_threads > 0)
+    {
+        int cpus[num_threads];
+        int available = cpu_topology_plan(&topology, placement, num_threads, cpus);
+        fprintf(out, " (%d CPUs), thread -> cpu:", available);
+        for (int iterator = 0; iterator < num_threads; ++iterator)
+        {
+            fprintf(out, " %d->%d", iterator, cpus[iterator]);
+        }
+        if (num_threads > available)
+            fprintf(out, "\n  warning: %d threads share %d CPUs", num_threads, available);
+    }
+    fprintf(out, "\n\n");
+}
+
+/* The original benchmark shape: readers think 100, writers 1000, empty critical sections */
+static workload_t default_workload(int num_readers, int num_writers, double seconds)
+{
+    workload_t w;
+    memset(&w, 0, sizeof(w));
+    w.num_readers = num_readers;
+    w.num_writers = num_writers;
+    w.read_think = 100;
+    w.write_think = 1000;
+    w.seconds = seconds;
+    return w;
+}
+
+/*
+ * Scaling run: 1 .. all online CPUs readers (plus num_writers writers) for
+ * each lock, one row per reader count, reads/s and writes/s per lock.
+ */
+static int run_scale(int num_writers, double seconds_per_step, const int *backends, int num_backends)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_readers = cpus > 0 ? (int)cpus : 1;
+
+    printf("%d writer(s), %.1f s per step, 1 .. %d readers\n", num_writers, seconds_per_step, max_readers);
+    printf("%8s", "readers");
+    for (int lock = 0; lock < num_backends; ++lock)
+    {
+        printf(" %16s %10s", rw_backend_name((rw_backend_t)backends[lock]), "writes/s");
+    }
+    printf("\n");
+
+    for (int readers = 1; readers <= max_readers; ++readers)
+    {
+        printf("%8d", readers);
+        workload_t w = default_workload(readers, num_writers, seconds_per_step);
+        for (int lock = 0; lock < num_backends; ++lock)
+        {
+            if (run_workload((rw_backend_t)backends[lock], &w) < 0)
+                return -1;
+            printf(" %16.0f %10.0f", (double)sharded_counter_sum(&reader_operations) / seconds_per_step,
+                   (double)sharded_counter_sum(&writer_operations) / seconds_per_step);
+            fflush(stdout);
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+/*
+ * Hash map run: the same readers and writers once per protection, one row
+ * each with reads/s, read and write latency and peak deferred memory.
+ */
+static int run_map(int num_readers, int num_writers, double seconds, const int *protections, int num_protections)
+{
+    int num_threads = num_readers + num_writers;
+    int cpus[num_threads > 0 ? num_threads : 1];
+    cpu_topology_plan(&topology, placement, num_threads, cpus);
+    map_workload_t w = {num_readers, num_writers, MAP_KEYS, 1000, seconds, cpus};
+
+    printf("%d reader(s), %d writer(s), %d keys, %.1f s per protection\n", num_readers, num_writers, MAP_KEYS,
+           seconds);
+    printf("%-15s %12s %10s %10s %10s %10s %10s %10s %12s %14s\n", "protection", "reads/s", "read p99", "writes/s",
+           "write p50", "write p99", "write max", "bad reads", "deferred KB", "deferred nodes");
+    for (int iterator = 0; iterator < num_protections; ++iterator)
+    {
+        static map_result_t result;
+        if (map_workload_run(protections[iterator], &w, &result) < 0)
+        {
+            perror(map_protection_name(protections[iterator]));
+            return -1;
+        }
+        printf("%-15s %12.0f %10.0f %10.0f %10.0f %10.0f %10.0f %10lu %12.1f %14lu\n",
+               map_protection_name(protections[iterator]), result.reads_per_second,
+               latency_ticks_to_ns(latency_percentile(&result.read_latency, 99.0)), result.writes_per_second,
+               latency_ticks_to_ns(latency_percentile(&result.write_latency, 50.0)),
+               latency_ticks_to_ns(latency_percentile(&result.write_latency, 99.0)),
+               latency_ticks_to_ns(result.write_latency.max), (unsigned long)result.bad_reads,
+               (double)result.peak_deferred_bytes / 1024.0, (unsigned long)result.peak_deferred_nodes);
+        fflush(stdout);
+    }
+    printf("(latencies in ns; deferred = peak retired entries not yet freed)\n");
+    return 0;
+}
+
+/*------------------------------------------------
+  Sweep mode
+-------------------------------------------------*/
+
+#define SWEEP_MAX_VALUES 32
+
+typedef struct
+{
+    int locks[RW_BACKEND_COUNT];
+    int num_locks;
+    int threads[SWEEP_MAX_VALUES];
+    int num_threads;
+    int write_percents[SWEEP_MAX_VALUES];
+    int num_write_percents;
+    int critical_sections[SWEEP_MAX_VALUES]; // do_busy_work() iterations in the lock
+    int num_critical_sections;
+    int think_times[SWEEP_MAX_VALUES]; // do_busy_work() iterations between ops
+    int num_think_times;
+    double seconds;
+    double warmup_seconds;
+    int trials;
+    int json;
+} sweep_config_t;
+
+typedef struct
+{
+    double mean;
+    double ci95; // Half-width of the 95% confidence interval of the mean
+} estimate_t;
+
+// Two-sided 95% Student t quantiles for 1 .. 30 degrees of freedom
+static const double t_quantile_95[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                         2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                         2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+static estimate_t estimate(const double *samples, int n)
+{
+    estimate_t e = {0.0, 0.0};
+    for (int iterator = 0; iterator < n; ++iterator)
+    {
+        e.mean += samples[iterator];
+    }
+    e.mean /= n;
+    if (n < 2)
+        return e;
+
+    double variance = 0.0;
+    for (int iterator = 0; iterator < n; ++iterator)
+    {
+        variance += (samples[iterator] - e.mean) * (samples[iterator] - e.mean);
+    }
+    variance /= n - 1;
+    double t = n - 1 <= 30 ? t_quantile_95[n - 2] : 1.960;
+    e.ci95 = t * sqrt(variance / n);
+    return e;
+}
+
+// "1,2,4" -> {1, 2, 4}; returns the count, or -1 on a malformed list
+static int parse_int_list(const char *text, int *values, int max_values)
+{
+    int count = 0;
+    const char *p = text;
+    while (*p != '\0')
+    {
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value < 0 || count == max_values || (*end != ',' && *end != '\0'))
+            return -1;
+        values[count++] = (int)value;
+        p = *end == ',' ? end + 1 : end;
+    }
+    return count > 0 ? count : -1;
+}
+
+static int parse_lock_list(const char *text, int *locks)
+{
+    char buffer[256];
+    int count = 0;
+    snprintf(buffer, sizeof(buffer), "%s", text);
+    for (char *name = strtok(buffer, ","); name != NULL; name = strtok(NULL, ","))
+    {
+        int backend = rw_backend_parse(name);
+        if (backend < 0 || count == RW_BACKEND_COUNT)
+        {
+            fprintf(stderr, "Unknown lock: %s\n", name);
+            return -1;
+        }
+        locks[count++] = backend;
+    }
+    return count > 0 ? count : -1;
+}
+
+static void print_estimate_json(const char *separator, const char *name, estimate_t e)
+{
+    printf("%s\"%s\": {\"mean\": %.6g, \"ci95\": %.6g}", separator, name, e.mean, e.ci95);
+}
+
+/*
+ * Every combination of lock x threads x write % x critical section x think
+ * time runs warmup + `trials` measured intervals; each row reports the mean
+ * and 95% confidence half-width over the trials. All threads are mixed:
+ * each op is a write with probability write_percent.
+ */
+static int run_sweep(const sweep_config_t *config)
+{
+    double reads[config->trials], writes[config->trials], total[config->trials];
+    double read_p99[config->trials], write_p99[config->trials], fairness[config->trials];
+    int rows = 0;
+
+    if (config->json)
+    {
+        printf("{\n  \"seconds\": %g, \"warmup_seconds\": %g, \"trials\": %d, \"placement\": \"%s\",\n",
+               config->seconds, config->warmup_seconds, config->trials, placement_name(placement));
+        printf("  \"cpus\": %d, \"cores\": %d, \"packages\": %d, \"numa_nodes\": %d,\n  \"results\": [\n",
+               topology.num_cpus, topology.num_cores, topology.num_packages, topology.num_nodes);
+    }
+    else
+    {
+        printf("lock,placement,threads,write_percent,critical_section,think_time,trials,"
+               "reads_per_s,reads_per_s_ci95,writes_per_s,writes_per_s_ci95,ops_per_s,ops_per_s_ci95,"
+               "read_wait_p99_ns,read_wait_p99_ns_ci95,write_wait_p99_ns,write_wait_p99_ns_ci95,"
+               "fairness,fairness_ci95,torn_reads\n");
+    }
+
+    for (int l = 0; l < config->num_locks; ++l)
+        for (int t = 0; t < config->num_threads; ++t)
+            for (int wp = 0; wp < config->num_write_percents; ++wp)
+                for (int cs = 0; cs < config->num_critical_sections; ++cs)
+                    for (int th = 0; th < config->num_think_times; ++th)
+                    {
+                        workload_t w;
+                        memset(&w, 0, sizeof(w));
+                        w.num_mixed = config->threads[t];
+                        w.write_percent = config->write_percents[wp];
+                        w.read_cs = w.write_cs = config->critical_sections[cs];
+                        w.read_think = w.write_think = config->think_times[th];
+                        w.warmup_seconds = config->warmup_seconds;
+                        w.seconds = config->seconds;
+                        const char *lock = rw_backend_name((rw_backend_t)config->locks[l]);
+
+                        fprintf(stderr, "%s threads=%d write%%=%d cs=%d think=%d\n", lock, w.num_mixed,
+                                w.write_percent, w.read_cs, w.read_think);
+                        uint64_t torn = 0;
+                        for (int trial = 0; trial < config->trials; ++trial)
+                        {
+                            run_result_t r;
+                            if (run_workload((rw_backend_t)config->locks[l], &w) < 0)
+                                return -1;
+                            collect_result(&w, &r);
+                            reads[trial] = r.reads_per_second;
+                            writes[trial] = r.writes_per_second;
+                            total[trial] = r.reads_per_second + r.writes_per_second;
+                            read_p99[trial] = r.read_wait_p99_ns;
+                            write_p99[trial] = r.write_wait_p99_ns;
+                            fairness[trial] = r.fairness;
+                            torn += r.torn_reads;
+                        }
+
+                        estimate_t e_reads = estimate(reads, config->trials);
+                        estimate_t e_writes = estimate(writes, config->trials);
+                        estimate_t e_total = estimate(total, config->trials);
+                        estimate_t e_read_p99 = estimate(read_p99, config->trials);
+                        estimate_t e_write_p99 = estimate(write_p99, config->trials);
+                        estimate_t e_fairness = estimate(fairness, config->trials);
+
+                        if (config->json)
+                        {
+                            printf("%s    {\"lock\": \"%s\", \"placement\": \"%s\", \"threads\": %d, \"write_percent\": %d, "
+                                   "\"critical_section\": %d, \"think_time\": %d,\n     ",
+                                   rows ? ",\n" : "", lock, placement_name(placement), w.num_mixed, w.write_percent,
+                                   w.read_cs, w.read_think);
+                            print_estimate_json("", "reads_per_s", e_reads);
+                            print_estimate_json(", ", "writes_per_s", e_writes);
+                            print_estimate_json(", ", "ops_per_s", e_total);
+                            print_estimate_json(",\n     ", "read_wait_p99_ns", e_read_p99);
+                            print_estimate_json(", ", "write_wait_p99_ns", e_write_p99);
+                            print_estimate_json(", ", "fairness", e_fairness);
+                            printf(", \"torn_reads\": %lu}", (unsigned long)torn);
+                        }
+                        else
+                        {
+                            printf("%s,%s,%d,%d,%d,%d,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.4f,%.4f,%lu\n",
+                                   lock, placement_name(placement), w.num_mixed, w.write_percent, w.read_cs, w.read_think, config->trials,
+                                   e_reads.mean, e_reads.ci95, e_writes.mean, e_writes.ci95, e_total.mean, e_total.ci95,
+                                   e_read_p99.mean, e_read_p99.ci95, e_write_p99.mean, e_write_p99.ci95,
+                                   e_fairness.mean, e_fairness.ci95, (unsigned long)torn);
+                        }
+                        fflush(stdout);
+                        rows++;
+                    }
+
+    if (config->json)
+        printf("\n  ]\n}\n");
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s <num_readers> <num_writers> <runtime_seconds> [lock]\n", prog);
+    fprintf(stderr, "       %s scale <num_writers> <seconds_per_step> [lock ...]\n", prog);
+    fprintf(stderr, "       %s map <num_readers> <num_writers> <seconds> [lock|epoch ...]\n", prog);
+    fprintf(stderr, "       %s sweep [--locks a,b] [--threads 1,2,4] [--write-percent 0,1,10]\n", prog);
+    fprintf(stderr, "                [--cs 0,100] [--think 100,1000] [--seconds s] [--warmup s]\n");
+    fprintf(stderr, "                [--trials n] [--format csv|json]\n");
+    fprintf(stderr, "  lock: pthread-rwlock (default), pthread-mutex, ticket, seqlock, futex-rwlock,\n");
+    fprintf(stderr, "        percpu-rwlock, bravo\n");
+    fprintf(stderr, "  map mode: any lock but seqlock, or epoch (lock-free readers, deferred frees)\n");
+    fprintf(stderr, "  every mode also takes --placement none|compact|scatter|physical|numa-node\n");
+}
+
+static int parse_sweep(int argc, char **argv, sweep_config_t *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->num_locks = parse_lock_list("pthread-rwlock,futex-rwlock,percpu-rwlock,seqlock", config->locks);
+
+    /* Threads: powers of two up to the online CPUs, plus that count itself */
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long threads = 1; threads <= cpus && config->num_threads < SWEEP_MAX_VALUES - 1; threads *= 2)
+    {
+        config->threads[config->num_threads++] = (int)threads;
+    }
+    if (config->num_threads == 0 || config->threads[config->num_threads - 1] != cpus)
+        config->threads[config->num_threads++] = cpus > 0 ? (int)cpus : 1;
+
+    config->num_write_percents = parse_int_list("0,1,10,50", config->write_percents, SWEEP_MAX_VALUES);
+    config->num_critical_sections = parse_int_list("0,100", config->critical_sections, SWEEP_MAX_VALUES);
+    config->num_think_times = parse_int_list("100,1000", config->think_times, SWEEP_MAX_VALUES);
+    config->seconds = 1.0;
+    config->warmup_seconds = 0.2;
+    config->trials = 3;
+
+    for (int iterator = 2; iterator < argc; ++iterator)
+    {
+        const char *option = argv[iterator];
+        const char *value = iterator + 1 < argc ? argv[iterator + 1] : NULL;
+        if (value == NULL)
+            return -1;
+        iterator++;
+
+        if (strcmp(option, "--locks") == 0)
+            config->num_locks = parse_lock_list(value, config->locks);
+        else if (strcmp(option, "--threads") == 0)
+            config->num_threads = parse_int_list(value, config->threads, SWEEP_MAX_VALUES);
+        else if (strcmp(option, "--write-percent") == 0)
+            config->num_write_percents = parse_int_list(value, config->write_percents, SWEEP_MAX_VALUES);
+        else if (strcmp(option, "--cs") == 0)
+            config->num_critical_sections = parse_int_list(value, config->critical_sections, SWEEP_MAX_VALUES);
+        else if (strcmp(option, "--think") == 0)
+            config->num_think_times = parse_int_list(value, config->think_times, SWEEP_MAX_VALUES);
+        else if (strcmp(option, "--seconds") == 0)
+            config->seconds = atof(value);
+        else if (strcmp(option, "--warmup") == 0)
+            config->warmup_seconds = atof(value);
+        else if (strcmp(option, "--trials") == 0)
+            config->trials = atoi(value);
+        else if (strcmp(option, "--format") == 0 && (strcmp(value, "csv") == 0 || strcmp(value, "json") == 0))
+            config->json = strcmp(value, "json") == 0;
+        else
+            return -1;
+    }
+
+    if (config->num_locks < 0 || config->num_threads < 0 || config->num_write_percents < 0 ||
+        config->num_critical_sections < 0 || config->num_think_times < 0 || config->seconds <= 0.0 ||
+        config->warmup_seconds < 0.0 || config->trials < 1)
+        return -1;
+    for (int iterator = 0; iterator < config->num_threads; ++iterator)
+    {
+        if (config->threads[iterator] < 1)
+            return -1;
+    }
+    for (int iterator = 0; iterator < config->num_write_percents; ++iterator)
+    {
+        if (config->write_percents[iterator] > 100)
+            return -1;
+    }
+    return 0;
+}
+
 int main(int argc, char **argv)
 {
-    if (argc != 4)
+    latency_calibrate();
+    if (cpu_topology_load(&topology) < 0)
     {
-        fprintf(stderr, "Usage: %s <num_readers> <num_writers> <runtime_seconds>\n", argv[0]);
+        perror("cpu_topology_load");
         return 1;
     }
 
-    int num_readers = atoi(argv[1]);
-    int num_writers = atoi(argv[2]);
-    int runtime_seconds = atoi(argv[3]);
-
-    pthread_t reader_threads[num_readers];
-    pthread_t writer_threads[num_writers];
+    /* Pull "--placement <policy>" out of argv before the mode parsers see it */
+    int kept = 1;
+    for (int iterator = 1; iterator < argc; ++iterator)
+    {
+        if (strcmp(argv[iterator], "--placement") == 0 && iterator + 1 < argc)
+        {
+            int parsed = placement_parse(argv[++iterator]);
+            if (parsed < 0)
+            {
+                fprintf(stderr, "Unknown placement: %s\n", argv[iterator]);
+                return 1;
+            }
+            placement = (placement_t)parsed;
+        }
+        else
+        {
+            argv[kept++] = argv[iterator];
+        }
+    }
+    argc = kept;
 
-    for (int iterator = 0; iterator < num_readers; ++iterator)
+    if (argc >= 2 && strcmp(argv[1], "sweep") == 0)
     {
-        pthread_create(&reader_threads[iterator], NULL, reader_thread, NULL);
+        sweep_config_t config;
+        if (parse_sweep(argc, argv, &config) < 0)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        print_placement(stderr, 0);
+        return run_sweep(&config) < 0 ? 1 : 0;
     }
-    for (int iterator = 0; iterator < num_writers; ++iterator)
+
+    if (argc >= 4 && strcmp(argv[1], "scale") == 0)
     {
-        pthread_create(&writer_threads[iterator], NULL, writer_thread, NULL);
+        int backends[RW_BACKEND_COUNT] = {RW_PTHREAD_RWLOCK, RW_PERCPU_RWLOCK, RW_BRAVO};
+        int num_backends = 3;
+        if (argc > 4)
+        {
+            num_backends = 0;
+            for (int iterator = 4; iterator < argc && num_backends < RW_BACKEND_COUNT; ++iterator)
+            {
+                backends[num_backends] = rw_backend_parse(argv[iterator]);
+                if (backends[num_backends] < 0)
+                {
+                    fprintf(stderr, "Unknown lock: %s\n", argv[iterator]);
+                    return 1;
+                }
+                num_backends++;
+            }
+        }
+        print_placement(stdout, 0);
+        return run_scale(atoi(argv[2]), atof(argv[3]), backends, num_backends) < 0 ? 1 : 0;
     }
 
-    sleep(runtime_seconds);
-    stop_requested = 1;
+    if (argc >= 5 && strcmp(argv[1], "map") == 0)
+    {
+        int protections[MAP_PROTECTION_COUNT] = {RW_PTHREAD_RWLOCK, RW_PERCPU_RWLOCK, RW_BRAVO, MAP_EPOCH};
+        int num_protections = 4;
+        if (argc > 5)
+        {
+            num_protections = 0;
+            for (int iterator = 5; iterator < argc && num_protections < MAP_PROTECTION_COUNT; ++iterator)
+            {
+                protections[num_protections] = map_protection_parse(argv[iterator]);
+                if (protections[num_protections] < 0 || protections[num_protections] == RW_SEQLOCK)
+                {
+                    fprintf(stderr, "Unknown or unsupported protection for map mode: %s\n", argv[iterator]);
+                    return 1;
+                }
+                num_protections++;
+            }
+        }
+        int num_readers = atoi(argv[2]);
+        int num_writers = atoi(argv[3]);
+        if (num_readers < 0 || num_writers < 0 || num_readers + num_writers < 1)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        print_placement(stdout, num_readers + num_writers);
+        return run_map(num_readers, num_writers, atof(argv[4]), protections, num_protections) < 0 ? 1 : 0;
+    }
 
-    for (int iterator = 0; iterator < num_readers; ++iterator)
+    if (argc != 4 && argc != 5)
     {
-        pthread_join(reader_threads[iterator], NULL);
+        usage(argv[0]);
+        return 1;
     }
-    for (int iterator = 0; iterator < num_writers; ++iterator)
+
+    int num_readers = atoi(argv[1]);
+    int num_writers = atoi(argv[2]);
+    double runtime_seconds = atof(argv[3]);
+    int backend = argc == 5 ? rw_backend_parse(argv[4]) : RW_PTHREAD_RWLOCK;
+    if (backend < 0)
     {
-        pthread_join(writer_threads[iterator], NULL);
+        fprintf(stderr, "Unknown lock: %s\n", argv[4]);
+        return 1;
     }
 
-    printf("Total Reads:  %lu\n", (unsigned long)atomic_load(&total_reader_operations));
-    printf("Total Writes: %lu\n", (unsigned long)atomic_load(&total_writer_operations));
-    printf("Final shared_counter = %d\n", shared_counter);
+    workload_t w = default_workload(num_readers, num_writers, runtime_seconds);
+    print_placement(stdout, total_threads(&w));
+    if (run_workload((rw_backend_t)backend, &w) < 0)
+        return 1;
 
-    pthread_rwlock_destroy(&rwlock);
+    printf("Lock:         %s\n", rw_backend_name((rw_backend_t)backend));
+    printf("Total Reads:  %lu\n", (unsigned long)sharded_counter_sum(&reader_operations));
+    printf("Total Writes: %lu\n", (unsigned long)sharded_counter_sum(&writer_operations));
+    printf("Read retries: %lu\n", (unsigned long)sharded_counter_sum(&read_retries));
+    printf("Torn reads:   %lu\n", (unsigned long)sharded_counter_sum(&torn_reads));
+    printf("Final shared_counter = %lu\n", (unsigned long)shared_state.counter);
+    print_latency_report(&w);
+    free(thread_args);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,152 @@
+// seqlock.h
+// -----------------------------------------------------------------------------
+// Sequence lock: optimistic readers, exclusive writers.
+//
+// The sequence is even while the data is stable and odd while a writer is in
+// the middle of an update. A reader samples the sequence, reads the data, and
+// retries if the sequence was odd or changed in between. Readers never write
+// shared memory, so any number of them proceed without bouncing a cache line.
+//
+//     unsigned seq;
+//     do {
+//         seq = seqlock_read_begin(&lock);
+//         ... read the protected data with relaxed atomic loads ...
+//     } while (seqlock_read_retry(&lock, seq));
+//
+// Writers exclude each other by moving the sequence from even to odd with a
+// CAS, so no separate writer mutex is needed.
+//
+// Because a reader can observe a half-finished update before it retries, the
+// protected data must be accessed with (relaxed) atomics and must not contain
+// pointers the reader dereferences. For a whole record (a struct of several
+// fields, size a multiple of 8, 8-byte aligned) SEQLOCK_READ / SEQLOCK_WRITE
+// do exactly that, one 64-bit word at a time:
+//
+//     static seqlock_t config_lock = SEQLOCK_INITIALIZER;
+//     static config_t config;
+//
+//     config_t snapshot;
+//     SEQLOCK_READ(&config_lock, &snapshot, &config);   // consistent copy
+//     SEQLOCK_WRITE(&config_lock, &config, &updated);   // publish new version
+// -----------------------------------------------------------------------------
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <sched.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cpu-relax.h"
+
+#define SEQLOCK_SPINS_BEFORE_YIELD 1024
+
+typedef struct
+{
+    unsigned sequence;
+} seqlock_t;
+
+#define SEQLOCK_INITIALIZER {0}
+
+// Wait until no writer is active and return the (even) sequence
+static inline unsigned seqlock_read_begin(const seqlock_t *lock)
+{
+    unsigned spins = 0;
+    unsigned seq;
+    while ((seq = __atomic_load_n(&lock->sequence, __ATOMIC_ACQUIRE)) & 1)
+    {
+        if (++spins < SEQLOCK_SPINS_BEFORE_YIELD)
+        {
+            cpu_relax();
+        }
+        else
+        {
+            spins = 0;
+            sched_yield();
+        }
+    }
+    return seq;
+}
+
+// Nonzero if a writer ran since seqlock_read_begin(): discard what was read
+static inline int seqlock_read_retry(const seqlock_t *lock, unsigned seq)
+{
+    // Keep the data loads above from sinking below the re-check
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&lock->sequence, __ATOMIC_RELAXED) != seq;
+}
+
+static inline void seqlock_write_lock(seqlock_t *lock)
+{
+    unsigned spins = 0;
+    for (;;)
+    {
+        unsigned seq = __atomic_load_n(&lock->sequence, __ATOMIC_RELAXED);
+        if (!(seq & 1) &&
+            __atomic_compare_exchange_n(&lock->sequence, &seq, seq + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            break;
+        if (++spins < SEQLOCK_SPINS_BEFORE_YIELD)
+        {
+            cpu_relax();
+        }
+        else
+        {
+            spins = 0;
+            sched_yield();
+        }
+    }
+    // The odd sequence must be visible before any of the data stores
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void seqlock_write_unlock(seqlock_t *lock)
+{
+    // Release: the data stores are visible before the sequence turns even
+    __atomic_store_n(&lock->sequence, lock->sequence + 1, __ATOMIC_RELEASE);
+}
+
+// Word-wise relaxed atomic copies: racing a writer is defined behaviour, the
+// result is simply discarded when seqlock_read_retry() says so
+static inline void seqlock_load_words(void *dst, const void *src, size_t size)
+{
+    uint64_t *d = (uint64_t *)dst;
+    const uint64_t *s = (const uint64_t *)src;
+    for (size_t iterator = 0; iterator < size / sizeof(uint64_t); iterator++)
+    {
+        d[iterator] = __atomic_load_n(&s[iterator], __ATOMIC_RELAXED);
+    }
+}
+
+static inline void seqlock_store_words(void *dst, const void *src, size_t size)
+{
+    uint64_t *d = (uint64_t *)dst;
+    const uint64_t *s = (const uint64_t *)src;
+    for (size_t iterator = 0; iterator < size / sizeof(uint64_t); iterator++)
+    {
+        __atomic_store_n(&d[iterator], s[iterator], __ATOMIC_RELAXED);
+    }
+}
+
+// Consistent snapshot of *src into *dst (same struct type)
+#define SEQLOCK_READ(lock, dst, src)                                                      \
+    do                                                                                    \
+    {                                                                                     \
+        _Static_assert(sizeof(*(src)) % sizeof(uint64_t) == 0, "record size % 8 != 0");  \
+        unsigned seq_;                                                                    \
+        do                                                                                \
+        {                                                                                 \
+            seq_ = seqlock_read_begin(lock);                                              \
+            seqlock_load_words((dst), (src), sizeof(*(src)));                             \
+        } while (seqlock_read_retry((lock), seq_));                                       \
+    } while (0)
+
+// Replace *dst with *src as one atomic-looking update
+#define SEQLOCK_WRITE(lock, dst, src)                                                     \
+    do                                                                                    \
+    {                                                                                     \
+        _Static_assert(sizeof(*(dst)) % sizeof(uint64_t) == 0, "record size % 8 != 0");  \
+        seqlock_write_lock(lock);                                                         \
+        seqlock_store_words((dst), (src), sizeof(*(dst)));                                \
+        seqlock_write_unlock(lock);                                                       \
+    } while (0)
+
+#endif // SEQLOCK_H
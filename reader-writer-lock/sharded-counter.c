@@ -0,0 +1,59 @@
+// sharded-counter.c
+// -----------------------------------------------------------------------------
+// Cache-line-padded sharded counters (see sharded-counter.h).
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <unistd.h>
+#include "sharded-counter.h"
+
+static unsigned next_shard;
+static __thread unsigned thread_shard = (unsigned)-1;
+
+int sharded_counter_init(sharded_counter_t *counter, unsigned num_shards)
+{
+    if (num_shards == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_CONF);
+        num_shards = cpus > 0 ? (unsigned)cpus : 1;
+    }
+    void *slots;
+    if (posix_memalign(&slots, SHARDED_COUNTER_CACHE_LINE, num_shards * sizeof(sharded_counter_slot_t)) != 0)
+        return -1;
+    counter->slots = slots;
+    counter->num_shards = num_shards;
+    sharded_counter_reset(counter);
+    return 0;
+}
+
+void sharded_counter_destroy(sharded_counter_t *counter)
+{
+    free(counter->slots);
+    counter->slots = NULL;
+    counter->num_shards = 0;
+}
+
+unsigned sharded_counter_shard(void)
+{
+    if (thread_shard == (unsigned)-1)
+        thread_shard = __atomic_fetch_add(&next_shard, 1, __ATOMIC_RELAXED);
+    return thread_shard;
+}
+
+uint64_t sharded_counter_sum(const sharded_counter_t *counter)
+{
+    uint64_t total = 0;
+    for (unsigned iterator = 0; iterator < counter->num_shards; iterator++)
+    {
+        total += __atomic_load_n(&counter->slots[iterator].value, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+void sharded_counter_reset(sharded_counter_t *counter)
+{
+    for (unsigned iterator = 0; iterator < counter->num_shards; iterator++)
+    {
+        counter->slots[iterator].value = 0;
+    }
+}
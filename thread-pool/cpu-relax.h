@@ -0,0 +1,23 @@
+// cpu-relax.h
+// -----------------------------------------------------------------------------
+// Spin-wait hint for the idle workers' spin-then-park loop (same as
+// reader-writer-lock/cpu-relax.h). On x86 "pause" keeps a spinning core from
+// flooding the memory pipeline and frees resources for its SMT sibling; on
+// aarch64 "yield" plays the same role.
+// -----------------------------------------------------------------------------
+
+#ifndef CPU_RELAX_H
+#define CPU_RELAX_H
+
+static inline void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+#endif // CPU_RELAX_H
@@ -0,0 +1,296 @@
+/*
+ * Thread pool benchmark: per-task threads vs a mutex queue vs work stealing
+ *
+ * Runs a batch of equal busy-loop tasks for each task size (100 ns .. 1 ms)
+ * with four strategies, all using num_workers threads:
+ *
+ *   pthread      pthread_create() per task, in waves of num_workers, then join
+ *                (what pthread-demo.c, rwlock.c and chat1.c do per job)
+ *   mutex-queue  fixed workers around one mutex + condition variable FIFO
+ *   ws-post      thread_pool_post() from the main thread (injection queue)
+ *   ws-for       thread_pool_parallel_for(), grain 1: tasks fan out through
+ *                the workers' deques and are stolen
+ *
+ * Every strategy counts finished tasks the same way (one shared atomic
+ * decrement per task). Reported per size: tasks/s, overhead per task
+ * (elapsed * workers / tasks - task size) and efficiency (ideal time /
+ * elapsed).
+ *
+ * Build: gcc -O2 -pthread thread-pool-bench.c thread-pool.c ws-deque.c -o thread-pool-bench
+ * Usage: ./thread-pool-bench [num_workers] [seconds_per_case]   (default: all CPUs, 0.5 s)
+ */
+
+#define _GNU_SOURCE
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "thread-pool.h"
+
+#define MIN_TASKS 64
+#define MAX_TASKS 200000
+
+/* Tasks still to finish in the current batch; the last one sets done */
+typedef struct
+{
+    uint32_t remaining;
+    uint32_t done;
+} countdown_t;
+
+/* One node of the mutex-queue baseline */
+typedef struct queue_node
+{
+    struct queue_node *next;
+} queue_node_t;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    queue_node_t *head;
+    queue_node_t *tail;
+    int shutdown;
+} mutex_queue_t;
+
+static double loops_per_ns; // Busy-loop calibration
+static long task_ns;        // Current task size
+static countdown_t countdown;
+static mutex_queue_t queue;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void do_busy_work(long iterations)
+{
+    volatile unsigned long temp = 0;
+    for (long iterator = 0; iterator < iterations; ++iterator)
+    {
+        temp += (unsigned long)iterator ^ (temp << 1);
+    }
+}
+
+static void calibrate(void)
+{
+    long iterations = 1000000;
+    double start = now_seconds();
+    do_busy_work(iterations);
+    loops_per_ns = (double)iterations / ((now_seconds() - start) * 1e9);
+}
+
+/*------------------------------------------------
+  Batch completion
+-------------------------------------------------*/
+static void countdown_start(uint32_t tasks)
+{
+    countdown.remaining = tasks;
+    countdown.done = 0;
+}
+
+static void countdown_finish_one(void)
+{
+    if (__atomic_sub_fetch(&countdown.remaining, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        __atomic_store_n(&countdown.done, 1, __ATOMIC_RELEASE);
+        syscall(SYS_futex, &countdown.done, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+static void countdown_wait(void)
+{
+    while (__atomic_load_n(&countdown.done, __ATOMIC_ACQUIRE) == 0)
+        syscall(SYS_futex, &countdown.done, FUTEX_WAIT_PRIVATE, 0, NULL, NULL, 0);
+}
+
+/* The task body shared by all strategies */
+static void run_task(void)
+{
+    do_busy_work((long)((double)task_ns * loops_per_ns));
+    countdown_finish_one();
+}
+
+/*------------------------------------------------
+  pthread: one thread per task
+-------------------------------------------------*/
+static void *thread_task(void *arg)
+{
+    run_task();
+    return arg;
+}
+
+static void run_pthread(int num_workers, int tasks)
+{
+    pthread_t threads[num_workers];
+    countdown_start((uint32_t)tasks);
+    for (int started = 0; started < tasks; started += num_workers)
+    {
+        int wave = tasks - started < num_workers ? tasks - started : num_workers;
+        for (int iterator = 0; iterator < wave; ++iterator)
+        {
+            pthread_create(&threads[iterator], NULL, thread_task, NULL);
+        }
+        for (int iterator = 0; iterator < wave; ++iterator)
+        {
+            pthread_join(threads[iterator], NULL);
+        }
+    }
+}
+
+/*------------------------------------------------
+  mutex-queue: one lock, one condition variable
+-------------------------------------------------*/
+static void *queue_worker(void *arg)
+{
+    for (;;)
+    {
+        pthread_mutex_lock(&queue.lock);
+        while (queue.head == NULL && !queue.shutdown)
+            pthread_cond_wait(&queue.not_empty, &queue.lock);
+        queue_node_t *node = queue.head;
+        if (node == NULL)
+        {
+            pthread_mutex_unlock(&queue.lock); // Shut down and drained
+            return arg;
+        }
+        queue.head = node->next;
+        if (queue.head == NULL)
+            queue.tail = NULL;
+        pthread_mutex_unlock(&queue.lock);
+
+        free(node);
+        run_task();
+    }
+}
+
+static void queue_push(void)
+{
+    queue_node_t *node = malloc(sizeof(*node));
+    if (node == NULL)
+        abort();
+    node->next = NULL;
+    pthread_mutex_lock(&queue.lock);
+    if (queue.tail != NULL)
+        queue.tail->next = node;
+    else
+        queue.head = node;
+    queue.tail = node;
+    pthread_cond_signal(&queue.not_empty);
+    pthread_mutex_unlock(&queue.lock);
+}
+
+/*------------------------------------------------
+  Work-stealing pool
+-------------------------------------------------*/
+static void post_task(void *arg)
+{
+    (void)arg;
+    run_task();
+}
+
+static void range_body(size_t begin, size_t end, void *arg)
+{
+    (void)arg;
+    for (size_t iterator = begin; iterator < end; ++iterator)
+    {
+        run_task();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_workers = argc >= 2 ? atoi(argv[1]) : (cpus > 0 ? (int)cpus : 1);
+    double seconds = argc >= 3 ? atof(argv[2]) : 0.5;
+    if (argc > 3 || num_workers < 1 || seconds <= 0.0)
+    {
+        fprintf(stderr, "Usage: %s [num_workers] [seconds_per_case]\n", argv[0]);
+        return 1;
+    }
+    calibrate();
+
+    /* Long-lived workers for the pooled strategies */
+    pthread_mutex_init(&queue.lock, NULL);
+    pthread_cond_init(&queue.not_empty, NULL);
+    pthread_t queue_workers[num_workers];
+    for (int iterator = 0; iterator < num_workers; ++iterator)
+    {
+        pthread_create(&queue_workers[iterator], NULL, queue_worker, NULL);
+    }
+    thread_pool_t *pool = thread_pool_create(num_workers);
+    if (pool == NULL)
+    {
+        perror("thread_pool_create");
+        return 1;
+    }
+
+    const long task_sizes[] = {100, 1000, 10000, 100000, 1000000};
+    const char *const strategies[] = {"pthread", "mutex-queue", "ws-post", "ws-for"};
+    printf("%d workers, ~%.1f s per case; overhead = ns per task beyond the work itself\n", num_workers, seconds);
+    printf("%10s %-12s %10s %12s %14s %11s\n", "task ns", "strategy", "tasks", "tasks/s", "overhead ns", "efficiency");
+
+    for (int size = 0; size < (int)(sizeof(task_sizes) / sizeof(task_sizes[0])); ++size)
+    {
+        task_ns = task_sizes[size];
+        double ideal_tasks = seconds * 1e9 * num_workers / (double)task_ns;
+        int tasks = ideal_tasks < MIN_TASKS ? MIN_TASKS : ideal_tasks > MAX_TASKS ? MAX_TASKS : (int)ideal_tasks;
+
+        for (int strategy = 0; strategy < 4; ++strategy)
+        {
+            double start = now_seconds();
+            switch (strategy)
+            {
+            case 0:
+                run_pthread(num_workers, tasks);
+                break;
+            case 1:
+                countdown_start((uint32_t)tasks);
+                for (int iterator = 0; iterator < tasks; ++iterator)
+                {
+                    queue_push();
+                }
+                break;
+            case 2:
+                countdown_start((uint32_t)tasks);
+                for (int iterator = 0; iterator < tasks; ++iterator)
+                {
+                    if (thread_pool_post(pool, post_task, NULL) < 0)
+                        abort();
+                }
+                break;
+            default:
+                countdown_start((uint32_t)tasks);
+                if (thread_pool_parallel_for(pool, 0, (size_t)tasks, 1, range_body, NULL) < 0)
+                    abort();
+                break;
+            }
+            countdown_wait();
+            double elapsed = now_seconds() - start;
+
+            double ideal = (double)tasks * (double)task_ns * 1e-9 / num_workers;
+            printf("%10ld %-12s %10d %12.0f %14.0f %10.1f%%\n", task_ns, strategies[strategy], tasks,
+                   (double)tasks / elapsed, elapsed * 1e9 * num_workers / tasks - (double)task_ns,
+                   100.0 * ideal / elapsed);
+            fflush(stdout);
+        }
+    }
+
+    /* Stop the baseline workers */
+    pthread_mutex_lock(&queue.lock);
+    queue.shutdown = 1;
+    pthread_cond_broadcast(&queue.not_empty);
+    pthread_mutex_unlock(&queue.lock);
+    for (int iterator = 0; iterator < num_workers; ++iterator)
+    {
+        pthread_join(queue_workers[iterator], NULL);
+    }
+    thread_pool_destroy(pool);
+    return 0;
+}
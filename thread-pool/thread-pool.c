@@ -0,0 +1,483 @@
+// thread-pool.c
+// -----------------------------------------------------------------------------
+// Work-stealing thread pool (see thread-pool.h).
+// -----------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "thread-pool.h"
+#include "ws-deque.h"
+#include "cpu-relax.h"
+
+#define DEQUE_CAPACITY 256          // Initial per-worker capacity; grows on demand
+#define HELPER_WAIT_NS 1000000      // A waiting worker re-checks for tasks at least this often
+
+/* Every queued item starts with this header; run() executes and frees it */
+typedef struct task
+{
+    void (*run)(struct task *task);
+    struct task *next; // Injection queue link
+} task_t;
+
+typedef struct
+{
+    task_t task;
+    void (*fn)(void *arg);
+    void *arg;
+} post_task_t;
+
+/* Completion flag: 0 = pending, 1 = done, 2 = pending with a parked waiter */
+struct thread_pool_future
+{
+    task_t task;
+    thread_pool_t *pool;
+    void *(*fn)(void *arg);
+    void *arg;
+    void *result;
+    uint32_t done;
+};
+
+typedef struct
+{
+    thread_pool_t *pool;
+    void (*body)(size_t begin, size_t end, void *arg);
+    void *arg;
+    size_t grain;
+    uint32_t pending; // Ranges queued or running
+    uint32_t done;    // Completion flag, as for futures
+} parallel_for_t;
+
+typedef struct
+{
+    task_t task;
+    parallel_for_t *job;
+    size_t begin;
+    size_t end;
+} range_task_t;
+
+typedef struct
+{
+    ws_deque_t deque;
+    thread_pool_t *pool;
+    pthread_t thread;
+    uint64_t rng_state; // Victim choice
+    int started;        // Thread is running (joined at destroy)
+} __attribute__((aligned(64))) worker_t;
+
+struct thread_pool
+{
+    worker_t *workers;
+    int num_workers;
+    pthread_mutex_t inject_lock; // Tasks from threads outside the pool
+    task_t *inject_head;
+    task_t *inject_tail;
+    uint32_t wake_seq __attribute__((aligned(64))); // Futex parked workers wait on
+    uint32_t sleepers;
+    int shutdown;
+};
+
+static __thread worker_t *current_worker; // NULL outside pool threads
+
+static void futex_wait(uint32_t *addr, uint32_t expected, const struct timespec *timeout)
+{
+    // Returns at once (EAGAIN) if *addr != expected: no lost wake-ups
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, timeout, NULL, 0);
+}
+
+static void futex_wake(uint32_t *addr, int count)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+// xorshift64: victim selection
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static worker_t *worker_of(const thread_pool_t *pool)
+{
+    return current_worker != NULL && current_worker->pool == pool ? current_worker : NULL;
+}
+
+/*------------------------------------------------
+  Completion flags
+-------------------------------------------------*/
+static void flag_complete(uint32_t *flag)
+{
+    // The waiter may free the flag as soon as it reads 1; a wake on freed
+    // memory is harmless (at worst a spurious wake-up of another futex)
+    if (__atomic_exchange_n(flag, 1, __ATOMIC_RELEASE) == 2)
+        futex_wake(flag, INT_MAX);
+}
+
+/*------------------------------------------------
+  Queueing
+-------------------------------------------------*/
+static void notify(thread_pool_t *pool)
+{
+    // Pairs with the sleepers increment in worker_main(): either the parking
+    // worker sees the new task or we see the sleeper
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&pool->sleepers, __ATOMIC_RELAXED) > 0)
+    {
+        __atomic_add_fetch(&pool->wake_seq, 1, __ATOMIC_RELEASE);
+        futex_wake(&pool->wake_seq, 1);
+    }
+}
+
+static void enqueue(thread_pool_t *pool, task_t *task)
+{
+    worker_t *self = worker_of(pool);
+    if (self == NULL || ws_deque_push(&self->deque, task) < 0)
+    {
+        /* Outside the pool (or the deque could not grow): injection queue */
+        task->next = NULL;
+        pthread_mutex_lock(&pool->inject_lock);
+        if (pool->inject_tail != NULL)
+            pool->inject_tail->next = task;
+        else
+            __atomic_store_n(&pool->inject_head, task, __ATOMIC_RELEASE);
+        pool->inject_tail = task;
+        pthread_mutex_unlock(&pool->inject_lock);
+    }
+    notify(pool);
+}
+
+static task_t *take_injected(thread_pool_t *pool)
+{
+    if (__atomic_load_n(&pool->inject_head, __ATOMIC_ACQUIRE) == NULL)
+        return NULL; // Common case: no lock taken
+    pthread_mutex_lock(&pool->inject_lock);
+    task_t *task = pool->inject_head;
+    if (task != NULL)
+    {
+        __atomic_store_n(&pool->inject_head, task->next, __ATOMIC_RELAXED);
+        if (task->next == NULL)
+            pool->inject_tail = NULL;
+    }
+    pthread_mutex_unlock(&pool->inject_lock);
+    return task;
+}
+
+// Own deque, then the injection queue, then the other workers' deques
+static task_t *find_task(thread_pool_t *pool, worker_t *self)
+{
+    task_t *task = ws_deque_pop(&self->deque);
+    if (task != NULL)
+        return task;
+    task = take_injected(pool);
+    if (task != NULL)
+        return task;
+
+    int start = (int)(next_random(&self->rng_state) % (uint64_t)pool->num_workers);
+    for (int iterator = 0; iterator < pool->num_workers; ++iterator)
+    {
+        worker_t *victim = &pool->workers[(start + iterator) % pool->num_workers];
+        if (victim == self)
+            continue;
+        task = ws_deque_steal(&victim->deque);
+        if (task != NULL)
+            return task;
+    }
+    return NULL;
+}
+
+static int work_visible(thread_pool_t *pool)
+{
+    if (__atomic_load_n(&pool->inject_head, __ATOMIC_ACQUIRE) != NULL)
+        return 1;
+    for (int iterator = 0; iterator < pool->num_workers; ++iterator)
+    {
+        if (!ws_deque_empty(&pool->workers[iterator].deque))
+            return 1;
+    }
+    return 0;
+}
+
+/*------------------------------------------------
+  Wait for a completion flag
+  - Workers run other tasks meanwhile and never
+    park for longer than HELPER_WAIT_NS
+  - Other threads park until woken
+-------------------------------------------------*/
+static void flag_wait(thread_pool_t *pool, uint32_t *flag)
+{
+    worker_t *self = worker_of(pool);
+    const struct timespec helper_wait = {0, HELPER_WAIT_NS};
+    int idle = 0;
+    while (__atomic_load_n(flag, __ATOMIC_ACQUIRE) != 1)
+    {
+        if (self != NULL)
+        {
+            task_t *task = find_task(pool, self);
+            if (task != NULL)
+            {
+                task->run(task);
+                idle = 0;
+                continue;
+            }
+        }
+        if (++idle < THREAD_POOL_SPIN)
+        {
+            cpu_relax();
+            continue;
+        }
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(flag, &expected, 2, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) || expected == 2)
+            futex_wait(flag, 2, self != NULL ? &helper_wait : NULL);
+        idle = 0;
+    }
+}
+
+/*------------------------------------------------
+  Worker thread: run tasks, spin, then park
+-------------------------------------------------*/
+static void *worker_main(void *arg)
+{
+    worker_t *self = (worker_t *)arg;
+    thread_pool_t *pool = self->pool;
+    current_worker = self;
+
+    int idle = 0;
+    for (;;)
+    {
+        task_t *task = find_task(pool, self);
+        if (task != NULL)
+        {
+            task->run(task);
+            idle = 0;
+            continue;
+        }
+        if (__atomic_load_n(&pool->shutdown, __ATOMIC_ACQUIRE))
+            break; // Nothing left anywhere
+        if (++idle < THREAD_POOL_SPIN)
+        {
+            cpu_relax();
+            continue;
+        }
+
+        /* Park: announce, re-check, sleep unless wake_seq moved */
+        uint32_t seq = __atomic_load_n(&pool->wake_seq, __ATOMIC_ACQUIRE);
+        __atomic_add_fetch(&pool->sleepers, 1, __ATOMIC_SEQ_CST);
+        if (!work_visible(pool) && !__atomic_load_n(&pool->shutdown, __ATOMIC_ACQUIRE))
+            futex_wait(&pool->wake_seq, seq, NULL);
+        __atomic_sub_fetch(&pool->sleepers, 1, __ATOMIC_RELAXED);
+        idle = 0;
+    }
+    return NULL;
+}
+
+thread_pool_t *thread_pool_create(int num_workers)
+{
+    if (num_workers <= 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_workers = cpus > 0 ? (int)cpus : 1;
+    }
+
+    thread_pool_t *pool = calloc(1, sizeof(*pool));
+    if (pool == NULL)
+        return NULL;
+    if (posix_memalign((void **)&pool->workers, 64, (size_t)num_workers * sizeof(worker_t)) != 0)
+    {
+        free(pool);
+        errno = ENOMEM;
+        return NULL;
+    }
+    memset(pool->workers, 0, (size_t)num_workers * sizeof(worker_t));
+    pthread_mutex_init(&pool->inject_lock, NULL);
+
+    pool->num_workers = num_workers;
+    for (int iterator = 0; iterator < num_workers; ++iterator)
+    {
+        worker_t *worker = &pool->workers[iterator];
+        worker->pool = pool;
+        worker->rng_state = 0x9e3779b97f4a7c15ULL * (uint64_t)(iterator + 1);
+        if (ws_deque_init(&worker->deque, DEQUE_CAPACITY) < 0)
+        {
+            thread_pool_destroy(pool);
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+
+    /* Every deque exists before any worker may try to steal from it */
+    for (int iterator = 0; iterator < num_workers; ++iterator)
+    {
+        int error = pthread_create(&pool->workers[iterator].thread, NULL, worker_main, &pool->workers[iterator]);
+        if (error != 0)
+        {
+            thread_pool_destroy(pool);
+            errno = error;
+            return NULL;
+        }
+        pool->workers[iterator].started = 1;
+    }
+    return pool;
+}
+
+void thread_pool_destroy(thread_pool_t *pool)
+{
+    if (pool == NULL)
+        return;
+    __atomic_store_n(&pool->shutdown, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&pool->wake_seq, 1, __ATOMIC_SEQ_CST);
+    futex_wake(&pool->wake_seq, INT_MAX);
+
+    for (int iterator = 0; iterator < pool->num_workers; ++iterator)
+    {
+        if (pool->workers[iterator].started)
+            pthread_join(pool->workers[iterator].thread, NULL);
+    }
+    for (int iterator = 0; iterator < pool->num_workers; ++iterator)
+    {
+        ws_deque_destroy(&pool->workers[iterator].deque); // Also one never initialized
+    }
+    pthread_mutex_destroy(&pool->inject_lock);
+    free(pool->workers);
+    free(pool);
+}
+
+int thread_pool_num_workers(const thread_pool_t *pool)
+{
+    return pool->num_workers;
+}
+
+/*------------------------------------------------
+  post
+-------------------------------------------------*/
+static void run_post(task_t *task)
+{
+    post_task_t *post = (post_task_t *)task;
+    post->fn(post->arg);
+    free(post);
+}
+
+int thread_pool_post(thread_pool_t *pool, void (*fn)(void *arg), void *arg)
+{
+    post_task_t *post = malloc(sizeof(*post));
+    if (post == NULL)
+        return -1;
+    post->task.run = run_post;
+    post->fn = fn;
+    post->arg = arg;
+    enqueue(pool, &post->task);
+    return 0;
+}
+
+/*------------------------------------------------
+  submit / futures
+-------------------------------------------------*/
+static void run_future(task_t *task)
+{
+    thread_pool_future_t *future = (thread_pool_future_t *)task;
+    future->result = future->fn(future->arg);
+    flag_complete(&future->done); // Not freed here: the future belongs to the submitter
+}
+
+thread_pool_future_t *thread_pool_submit(thread_pool_t *pool, void *(*fn)(void *arg), void *arg)
+{
+    thread_pool_future_t *future = malloc(sizeof(*future));
+    if (future == NULL)
+        return NULL;
+    future->task.run = run_future;
+    future->pool = pool;
+    future->fn = fn;
+    future->arg = arg;
+    future->result = NULL;
+    future->done = 0;
+    enqueue(pool, &future->task);
+    return future;
+}
+
+void *thread_pool_future_get(thread_pool_future_t *future)
+{
+    flag_wait(future->pool, &future->done);
+    return future->result;
+}
+
+int thread_pool_future_ready(const thread_pool_future_t *future)
+{
+    return __atomic_load_n(&future->done, __ATOMIC_ACQUIRE) == 1;
+}
+
+void thread_pool_future_free(thread_pool_future_t *future)
+{
+    free(future);
+}
+
+/*------------------------------------------------
+  parallel_for: split in halves, keep the left
+  half, queue the right one for thieves
+-------------------------------------------------*/
+static void run_range(task_t *task);
+
+static void split_and_run(parallel_for_t *job, size_t begin, size_t end)
+{
+    while (end - begin > job->grain)
+    {
+        size_t middle = begin + (end - begin) / 2;
+        range_task_t *right = malloc(sizeof(*right));
+        if (right == NULL)
+            break; // Run the rest here in one piece
+        right->task.run = run_range;
+        right->job = job;
+        right->begin = middle;
+        right->end = end;
+        __atomic_add_fetch(&job->pending, 1, __ATOMIC_RELAXED);
+        enqueue(job->pool, &right->task);
+        end = middle;
+    }
+    job->body(begin, end, job->arg);
+    if (__atomic_sub_fetch(&job->pending, 1, __ATOMIC_ACQ_REL) == 0)
+        flag_complete(&job->done);
+}
+
+static void run_range(task_t *task)
+{
+    range_task_t *range = (range_task_t *)task;
+    parallel_for_t *job = range->job;
+    size_t begin = range->begin, end = range->end;
+    free(range);
+    split_and_run(job, begin, end);
+}
+
+int thread_pool_parallel_for(thread_pool_t *pool, size_t begin, size_t end, size_t grain,
+                             void (*body)(size_t begin, size_t end, void *arg), void *arg)
+{
+    if (begin >= end)
+        return 0;
+    parallel_for_t job = {pool, body, arg, grain > 0 ? grain : 1, 1, 0};
+
+    if (worker_of(pool) != NULL)
+    {
+        split_and_run(&job, begin, end); // Already on a worker: start splitting here
+    }
+    else
+    {
+        range_task_t *root = malloc(sizeof(*root));
+        if (root == NULL)
+            return -1;
+        root->task.run = run_range;
+        root->job = &job;
+        root->begin = begin;
+        root->end = end;
+        enqueue(pool, &root->task);
+    }
+    flag_wait(pool, &job.done);
+    return 0;
+}
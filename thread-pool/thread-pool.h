@@ -0,0 +1,69 @@
+// thread-pool.h
+// -----------------------------------------------------------------------------
+// Work-stealing thread pool: a fixed set of workers instead of one
+// pthread_create() per job.
+//
+// Every worker owns a Chase-Lev deque (ws-deque.h). Tasks spawned by a worker
+// (parallel-for splits, tasks submitted from inside tasks) go to its own deque
+// and are popped LIFO, so they run hot in cache with no shared lock. A worker
+// whose deque is empty takes from the pool's injection queue (tasks submitted
+// by outside threads), then steals the oldest task of a random victim. Idle
+// workers spin briefly, then park on a futex; submitting wakes one parked
+// worker only if there is one, so a busy pool makes no system calls.
+//
+//     thread_pool_t *pool = thread_pool_create(0);          // one worker per CPU
+//
+//     thread_pool_post(pool, log_request, request);          // fire and forget
+//
+//     thread_pool_future_t *f = thread_pool_submit(pool, compute, input);
+//     result = thread_pool_future_get(f);                   // blocks (or helps)
+//     thread_pool_future_free(f);
+//
+//     thread_pool_parallel_for(pool, 0, n, 1024, scale_rows, &matrix);
+//
+//     thread_pool_destroy(pool);                            // runs what is queued
+//
+// A worker that waits (future_get, parallel_for) runs other tasks meanwhile,
+// so tasks may wait for tasks they spawned without deadlocking the pool.
+//
+// Build: gcc -O2 -pthread your-program.c thread-pool.c ws-deque.c
+// -----------------------------------------------------------------------------
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+
+#define THREAD_POOL_SPIN 256 // Idle polls before a worker parks
+
+typedef struct thread_pool thread_pool_t;
+typedef struct thread_pool_future thread_pool_future_t;
+
+// num_workers = 0: one per online CPU. NULL on error (errno set).
+thread_pool_t *thread_pool_create(int num_workers);
+
+// Runs every task already queued, then joins the workers. Must not be called
+// from a task.
+void thread_pool_destroy(thread_pool_t *pool);
+
+int thread_pool_num_workers(const thread_pool_t *pool);
+
+// Queue fn(arg). 0 or -1 (ENOMEM).
+int thread_pool_post(thread_pool_t *pool, void (*fn)(void *arg), void *arg);
+
+// Queue fn(arg) and return a future for its result. NULL on error.
+thread_pool_future_t *thread_pool_submit(thread_pool_t *pool, void *(*fn)(void *arg), void *arg);
+
+// Wait until the task ran and return its result (may be called repeatedly)
+void *thread_pool_future_get(thread_pool_future_t *future);
+int thread_pool_future_ready(const thread_pool_future_t *future);
+void thread_pool_future_free(thread_pool_future_t *future); // After get (or ready)
+
+// Call body on disjoint subranges covering [begin, end), each at most grain
+// long, in parallel; returns when all are done. The range is split in halves
+// on the workers' deques, so idle workers steal big pieces (a piece whose
+// split cannot be allocated runs unsplit). 0 or -1 (ENOMEM, nothing ran).
+int thread_pool_parallel_for(thread_pool_t *pool, size_t begin, size_t end, size_t grain,
+                             void (*body)(size_t begin, size_t end, void *arg), void *arg);
+
+#endif // THREAD_POOL_H
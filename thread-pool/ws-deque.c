@@ -0,0 +1,115 @@
+// ws-deque.c
+// -----------------------------------------------------------------------------
+// Chase-Lev work-stealing deque (see ws-deque.h).
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include "ws-deque.h"
+
+static ws_deque_buffer_t *buffer_create(int64_t capacity)
+{
+    ws_deque_buffer_t *buffer = malloc(sizeof(*buffer) + (size_t)capacity * sizeof(void *));
+    if (buffer == NULL)
+        return NULL;
+    buffer->capacity = capacity;
+    buffer->retired = NULL;
+    return buffer;
+}
+
+static void *slot_load(const ws_deque_buffer_t *buffer, int64_t index)
+{
+    return __atomic_load_n(&buffer->slots[index & (buffer->capacity - 1)], __ATOMIC_RELAXED);
+}
+
+static void slot_store(ws_deque_buffer_t *buffer, int64_t index, void *item)
+{
+    __atomic_store_n(&buffer->slots[index & (buffer->capacity - 1)], item, __ATOMIC_RELAXED);
+}
+
+int ws_deque_init(ws_deque_t *deque, int64_t capacity)
+{
+    deque->top = 0;
+    deque->bottom = 0;
+    deque->buffer = buffer_create(capacity);
+    return deque->buffer != NULL ? 0 : -1;
+}
+
+void ws_deque_destroy(ws_deque_t *deque)
+{
+    ws_deque_buffer_t *buffer = deque->buffer;
+    while (buffer != NULL)
+    {
+        ws_deque_buffer_t *retired = buffer->retired;
+        free(buffer);
+        buffer = retired;
+    }
+    deque->buffer = NULL;
+}
+
+int ws_deque_push(ws_deque_t *deque, void *item)
+{
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    int64_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    ws_deque_buffer_t *buffer = __atomic_load_n(&deque->buffer, __ATOMIC_RELAXED);
+
+    if (bottom - top > buffer->capacity - 1)
+    {
+        /* Full: copy the live range into a buffer twice the size */
+        ws_deque_buffer_t *grown = buffer_create(buffer->capacity * 2);
+        if (grown == NULL)
+            return -1;
+        for (int64_t index = top; index < bottom; ++index)
+        {
+            slot_store(grown, index, slot_load(buffer, index));
+        }
+        grown->retired = buffer;
+        __atomic_store_n(&deque->buffer, grown, __ATOMIC_RELEASE);
+        buffer = grown;
+    }
+
+    slot_store(buffer, bottom, item);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE); // Item visible before the new bottom
+    return 0;
+}
+
+void *ws_deque_pop(ws_deque_t *deque)
+{
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    ws_deque_buffer_t *buffer = __atomic_load_n(&deque->buffer, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+    // Claim the slot before reading top: a stealer either sees the new bottom or we see its top
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+    if (top > bottom)
+    {
+        /* Empty: restore bottom */
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    void *item = slot_load(buffer, bottom);
+    if (top == bottom)
+    {
+        /* Last element: race the stealers for it */
+        if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            item = NULL;
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return item;
+}
+
+void *ws_deque_steal(ws_deque_t *deque)
+{
+    int64_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+    if (top >= bottom)
+        return NULL;
+
+    ws_deque_buffer_t *buffer = __atomic_load_n(&deque->buffer, __ATOMIC_ACQUIRE);
+    void *item = slot_load(buffer, top);
+    if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return NULL; // Lost to the owner or another stealer
+    return item;
+}
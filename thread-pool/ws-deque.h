@@ -0,0 +1,54 @@
+// ws-deque.h
+// -----------------------------------------------------------------------------
+// Chase-Lev work-stealing deque of pointers (Chase & Lev, SPAA 2005; C11
+// memory orders from Le, Pop, Cohen & Zappa Nardelli, PPoPP 2013).
+//
+// The owner thread pushes and pops at the bottom (LIFO: the most recently
+// spawned, cache-hot task first) without any atomic read-modify-write except
+// when taking the very last element. Any other thread steals from the top
+// (FIFO: the oldest, usually largest task) with one CAS on `top`.
+//
+//     ws_deque_push(&mine, task);          // owner only
+//     task = ws_deque_pop(&mine);          // owner only, NULL if empty
+//     task = ws_deque_steal(&victim);      // any thread, NULL if empty or lost a race
+//
+// The ring buffer doubles when full. Old buffers may still be read by a
+// stealer that loaded the pointer before the swap, so they are kept until
+// ws_deque_destroy().
+//
+// Build: gcc -O2 your-program.c ws-deque.c
+// -----------------------------------------------------------------------------
+
+#ifndef WS_DEQUE_H
+#define WS_DEQUE_H
+
+#include <stdint.h>
+
+typedef struct ws_deque_buffer
+{
+    int64_t capacity; // Power of two
+    struct ws_deque_buffer *retired; // Previous (smaller) buffer, freed at destroy
+    void *slots[];
+} ws_deque_buffer_t;
+
+typedef struct
+{
+    int64_t top __attribute__((aligned(64)));    // Stealers CAS here
+    int64_t bottom __attribute__((aligned(64))); // Owner only writes here
+    ws_deque_buffer_t *buffer;
+} ws_deque_t;
+
+int ws_deque_init(ws_deque_t *deque, int64_t capacity); // 0 or -1; capacity: power of two
+void ws_deque_destroy(ws_deque_t *deque);
+
+int ws_deque_push(ws_deque_t *deque, void *item); // 0 or -1 (growing failed)
+void *ws_deque_pop(ws_deque_t *deque);
+void *ws_deque_steal(ws_deque_t *deque);
+
+// Racy size estimate, for idle checks only
+static inline int ws_deque_empty(const ws_deque_t *deque)
+{
+    return __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE) <= __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+}
+
+#endif // WS_DEQUE_H